@@ -1,9 +1,10 @@
 #include "StateMachine.h"
 #include "HardwareInterface.h"
 
+typedef HardwareInterface<ActiveBoard> Hardware;
 
-HardwareInterface hw;
-StateMachine sm(hw);
+Hardware hw;
+StateMachine<Hardware> sm(hw);
 
 void setup() {
       
@@ -2,46 +2,124 @@
 #define HARDWARE_CONFIG_H
 #include <Arduino.h>
 
-// Pin Definitions
-const int fanPin = 5;
-const int fuelPumpPin = 6;
-const int waterPumpPin = 7;
-const int blowerPin = 8;
-const int glowVoltsPin = 9;
-const int waterPumpSpeedPin = 10;
-const int powerCtlPin = 11;
-
-// Additional Analog Pins
-const int surfaceSensePin = A0;
-const int overtempSensePin = A1;
-const int flameSensePin = A2;
-const int fanCurrentSensePin = A3;
-const int glowCurrentSensePin = A4;
-const int waterPumpCurrentSensePin = A5;
-
 // Custom Mapping Struct
 struct VoltageTempMapping {
     int voltage;   // Input voltage
     int temperature; // Corresponding temperature
 };
 
-// Voltage-Temperature Mappings (Fixed-Size Arrays)
-const VoltageTempMapping waterTempMapping[] = {
-    {0, 20},   // 0V corresponds to 20°C
-    {128, 50}, // Midpoint 128 corresponds to 50°C
-    {250, 100} // Max voltage corresponds to 100°C
-};
+// Marks a signal the board does not route to the MCU
+constexpr uint8_t NO_PIN = 0xFF;
+
+// Board traits: everything that differs between controller boards lives in
+// one of these structs. HardwareInterface<Board> reads them at compile time,
+// so unused signals compile away and every I/O call inlines to a pin access.
+
+// Arduino Nano breadboard controller
+struct NanoBoard {
+    // Pin Definitions
+    static constexpr uint8_t fanPin = 9;            // OC1A, PwmEngine
+    static constexpr uint8_t fuelPumpPin = 6;
+    static constexpr uint8_t waterPumpPin = 7;
+    static constexpr uint8_t blowerPin = 8;
+    static constexpr uint8_t glowVoltsPin = 3;      // OC2B, PwmEngine
+    static constexpr uint8_t waterPumpSpeedPin = 10; // OC1B, PwmEngine
+    static constexpr uint8_t powerCtlPin = 11;
+
+    // PWM frequencies: fan and water pump above the audible range, glow
+    // plug slow enough for the high-side switch to follow
+    static constexpr uint32_t motorPwmHz = 20000;   // Timer1
+    static constexpr uint32_t glowPwmHz = 250;      // Timer2
+
+    // Additional Analog Pins
+    static constexpr uint8_t surfaceSensePin = A0;
+    static constexpr uint8_t overtempSensePin = A1;
+    static constexpr uint8_t flameSensePin = A2;
+    static constexpr uint8_t fanCurrentSensePin = A3;
+    static constexpr uint8_t glowCurrentSensePin = A4;
+    static constexpr uint8_t waterPumpCurrentSensePin = A5;
+
+    // Fuel pump: PWM duty proportional to the rate, full on at full scale
+    // (placeholder until the breadboard pump is measured)
+    static constexpr uint16_t fuelStrokeMicroliters = 0;
+    static constexpr uint16_t fuelPulseMillis = 0;
+    static constexpr uint16_t fuelFullScaleMlPerHour = 1000;
+
+    // Supply voltage for glow plug compensation; nominal when not sensed
+    static constexpr uint8_t supplySensePin = NO_PIN;
+    static constexpr uint16_t supplyFullScaleMillivolts = 0;
+    static constexpr uint16_t nominalSupplyMillivolts = 12000;
 
-const VoltageTempMapping flameTempMapping[] = {
-    {0, 100},  // 0V corresponds to 100°C
-    {128, 300}, // Midpoint 128 corresponds to 300°C
-    {250, 600}  // Max voltage corresponds to 600°C
+    // Voltage-Temperature Mappings (Fixed-Size Arrays)
+    static constexpr VoltageTempMapping waterTempMapping[] = {
+        {0, 20},   // 0V corresponds to 20°C
+        {128, 50}, // Midpoint 128 corresponds to 50°C
+        {250, 100} // Max voltage corresponds to 100°C
+    };
+
+    static constexpr VoltageTempMapping flameTempMapping[] = {
+        {0, 100},  // 0V corresponds to 100°C
+        {128, 300}, // Midpoint 128 corresponds to 300°C
+        {250, 600}  // Max voltage corresponds to 600°C
+    };
+
+    static constexpr VoltageTempMapping overTempMapping[] = {
+        {0, 50},   // 0V corresponds to 50°C
+        {128, 75}, // Midpoint 128 corresponds to 75°C
+        {250, 150} // Max voltage corresponds to 150°C
+    };
 };
 
-const VoltageTempMapping overTempMapping[] = {
-    {0, 50},   // 0V corresponds to 50°C
-    {128, 75}, // Midpoint 128 corresponds to 75°C
-    {250, 150} // Max voltage corresponds to 150°C
+// D5S interface board (Hardware/D5S.sch) carrying the Micro_Rev1j 32U4 core.
+// Pin numbers are the Arduino Micro mapping of the nets on that schematic.
+struct D5SMicroBoard {
+    // Pin Definitions
+    static constexpr uint8_t fanPin = 6;            // FAN_CTL, PD7
+    static constexpr uint8_t fuelPumpPin = 2;       // FUEL_PUMP_CTL, PD1
+    static constexpr uint8_t waterPumpPin = 3;      // WATER_PUMP_CTL, PD0
+    static constexpr uint8_t blowerPin = NO_PIN;
+    static constexpr uint8_t glowVoltsPin = 12;     // GLOW_CTL, PD6
+    static constexpr uint8_t waterPumpSpeedPin = NO_PIN;
+    static constexpr uint8_t powerCtlPin = NO_PIN;
+
+    // The fan runs on Timer4's OC4D above the audible range; the glow plug
+    // and fuel pump pulses are timed by PwmEngine's Timer1 interrupts, as
+    // PD6 and PD1 have no free timer output
+    static constexpr uint32_t motorPwmHz = 20000;   // Timer4
+    static constexpr uint32_t glowPwmHz = 250;
+
+    // Additional Analog Pins
+    static constexpr uint8_t surfaceSensePin = A1;  // V_SFC, PF6
+    static constexpr uint8_t overtempSensePin = A2; // V_OTEMP, PF5
+    static constexpr uint8_t flameSensePin = A0;    // V_FLAME, PF7
+    static constexpr uint8_t fanCurrentSensePin = A3;  // I_FAN, PF4
+    static constexpr uint8_t glowCurrentSensePin = A4; // I_GLOW, PF1
+    static constexpr uint8_t waterPumpCurrentSensePin = NO_PIN; // Sensed by IC1 only
+
+    // Fuel pump: Eberspächer dosing pump, one stroke per pulse on PD1.
+    // Stroke volume is a placeholder until a stroke count is weighed.
+    static constexpr uint16_t fuelStrokeMicroliters = 30;
+    static constexpr uint16_t fuelPulseMillis = 40;
+    static constexpr uint16_t fuelFullScaleMlPerHour = 0;
+
+    // V_SUP_MON reaches PF0 (A5), but D5S.sch draws no divider on it, so
+    // the pin floats and reads whatever the previous channel left behind.
+    // Nominal until the divider is on the schematic.
+    static constexpr uint8_t supplySensePin = NO_PIN;
+    static constexpr uint16_t supplyFullScaleMillivolts = 0;
+    static constexpr uint16_t nominalSupplyMillivolts = 12000;
+
+    // Same placeholder sensor tables as the Nano until the board is calibrated
+    static constexpr const VoltageTempMapping (&waterTempMapping)[3] = NanoBoard::waterTempMapping;
+    static constexpr const VoltageTempMapping (&flameTempMapping)[3] = NanoBoard::flameTempMapping;
+    static constexpr const VoltageTempMapping (&overTempMapping)[3] = NanoBoard::overTempMapping;
 };
 
+// Board selected by the PlatformIO environment
+#if defined(BOARD_D5S_MICRO)
+typedef D5SMicroBoard ActiveBoard;
+#else
+typedef NanoBoard ActiveBoard;
+#endif
+
 #endif // HARDWARE_CONFIG_H
@@ -3,22 +3,32 @@
 
 #include <Arduino.h>
 #include "HardwareConfig.h"
+#include "PwmEngine.h"
 
-// Define the HardwareInterface class
+// Arduino hardware layer for one board. Board is a traits struct from
+// HardwareConfig.h; pins and tables are compile-time constants, so the
+// methods below inline into StateMachine<HardwareInterface<Board>> with no
+// indirection. Mock or simulated backends provide the same methods.
+template <typename Board>
 class HardwareInterface {
 public:
     // Initialization
     void init();
 
-    // Output controls
+    // Output controls. Duties are 16-bit fractions of full scale; speeds
+    // are the same on a 0-255 scale.
     void setFanSpeed(uint8_t speed);
-    void setFuelPumpSpeed(uint8_t speed);
+    void setFanDuty(uint16_t duty);
+    void setFuelRate(uint16_t mlPerHour);      // Saturates at maxFuelRate
     void setWaterPumpState(bool state);
     void setBlowerState(bool state);
-    void setGlowState(bool state);
+    void setGlowVoltage(uint16_t millivolts);   // RMS across the plug, 0 = off
     void setWaterPumpSpeed(uint8_t speed);
     void setPowerControl(bool state);
 
+    // Latch the PWM duties set since the last call, all in the same period
+    void applyOutputs();
+
     // Input reading
     int readFlameSensor();
     int readSurfaceSensor();
@@ -29,14 +39,266 @@ public:
     int readGlowCurrent();
     int readWaterPumpCurrent();
 
+    // Supply voltage, or the board's nominal supply if it is not sensed
+    uint16_t readSupplyMillivolts();
+
+    // Highest fuel rate the board's pump drive delivers, in ml/h. A dosing
+    // pump is limited to one stroke per two pulse widths.
+    static constexpr uint16_t maxFuelRate = Board::fuelStrokeMicroliters == 0
+        ? Board::fuelFullScaleMlPerHour
+        : (Board::fuelPulseMillis == 0 ? 0 : 1800000UL / Board::fuelPulseMillis) * Board::fuelStrokeMicroliters / 1000;
+
     // Derived inputs
     int getWaterTemp();
     int getFlameTemp();
     int getOverTemp();
 
+    // Timing and logging for the state machine
+    unsigned long millis() { return ::millis(); }
+    void log(const char* message) { Serial.println(message); }
+    void log(const char* label, int value) { Serial.print(label); Serial.println(value); }
+
 private:
+    // Pin helpers; signals the board does not wire up (NO_PIN) compile away
+    static void initOutput(uint8_t pin);
+    static void writeDigital(uint8_t pin, bool state);
+    static int readAnalog(uint8_t pin);
+    template <uint8_t Pin>
+    static void writeDuty(uint16_t duty);
+
     // Interpolation helper
-    int interpolate(int rawValue, const VoltageTempMapping mapping[], size_t size);
+    template <size_t N>
+    static int interpolate(int rawValue, const VoltageTempMapping (&mapping)[N]);
 };
 
+// Initialize all hardware components
+template <typename Board>
+void HardwareInterface<Board>::init() {
+    Serial.begin(9600);
+
+    // Set digital output pins, default states: LOW or OFF
+    initOutput(Board::fanPin);
+    initOutput(Board::fuelPumpPin);
+    initOutput(Board::waterPumpPin);
+    initOutput(Board::blowerPin);
+    initOutput(Board::glowVoltsPin);
+    initOutput(Board::waterPumpSpeedPin);
+    initOutput(Board::powerCtlPin);
+
+#if PWM_ENGINE_AVAILABLE
+    PwmEngine::init(Board::motorPwmHz, Board::glowPwmHz);
+#endif
+}
+
+// Output controls
+template <typename Board>
+void HardwareInterface<Board>::setFanSpeed(uint8_t speed) {
+    setFanDuty(speed * 257U);
+}
+
+template <typename Board>
+void HardwareInterface<Board>::setFanDuty(uint16_t duty) {
+    writeDuty<Board::fanPin>(duty);
+}
+
+// A proportional pump gets a duty scaled to the board's full-scale rate; a
+// dosing pump gets one stroke per fuelStrokeMicroliters
+template <typename Board>
+void HardwareInterface<Board>::setFuelRate(uint16_t mlPerHour) {
+    if (mlPerHour > maxFuelRate) mlPerHour = maxFuelRate;
+    if constexpr (Board::fuelStrokeMicroliters != 0) {
+        static_assert(PwmEngine::strokesOn(Board::fuelPumpPin), "Dosing pump on a pin with no stroke output");
+        static_assert(1800000UL / Board::fuelPulseMillis <= 0xFFFF, "Fuel pulse too short for 16-bit strokes per hour");
+        uint32_t strokesPerHour = static_cast<uint32_t>(mlPerHour) * 1000U / Board::fuelStrokeMicroliters;
+        PwmEngine::setStrokeRate(static_cast<uint16_t>(strokesPerHour), Board::fuelPulseMillis);
+    } else {
+        static_assert(Board::fuelFullScaleMlPerHour != 0, "Proportional fuel pump needs a full-scale rate");
+        uint32_t duty = (static_cast<uint32_t>(mlPerHour) * 0xFFFFU) / Board::fuelFullScaleMlPerHour;
+        writeDuty<Board::fuelPumpPin>(static_cast<uint16_t>(duty));
+    }
+}
+
+template <typename Board>
+void HardwareInterface<Board>::setWaterPumpState(bool state) {
+    writeDigital(Board::waterPumpPin, state);
+}
+
+template <typename Board>
+void HardwareInterface<Board>::setBlowerState(bool state) {
+    writeDigital(Board::blowerPin, state);
+}
+
+// The plug is resistive, so Vrms = Vsupply * sqrt(duty) and the duty for a
+// target is (Vtarget / Vsupply)^2, worked in 16-bit fixed point. Only a
+// higher supply is compensated: a low reading never raises the duty above
+// what the nominal supply needs, so a bad sense cannot over-drive the plug.
+template <typename Board>
+void HardwareInterface<Board>::setGlowVoltage(uint16_t millivolts) {
+    uint16_t duty = 0;
+    if (millivolts != 0) {
+        uint32_t supply = readSupplyMillivolts();
+        if (supply < Board::nominalSupplyMillivolts) supply = Board::nominalSupplyMillivolts;
+        uint32_t ratio = (static_cast<uint32_t>(millivolts) << 16) / supply;
+        if (ratio > 0xFFFFUL) ratio = 0xFFFFUL;
+        duty = static_cast<uint16_t>((ratio * ratio) >> 16);
+        if (duty == 0) duty = 1;
+    }
+    writeDuty<Board::glowVoltsPin>(duty);
+}
+
+template <typename Board>
+void HardwareInterface<Board>::setWaterPumpSpeed(uint8_t speed) {
+    writeDuty<Board::waterPumpSpeedPin>(speed * 257U);
+}
+
+template <typename Board>
+void HardwareInterface<Board>::setPowerControl(bool state) {
+    writeDigital(Board::powerCtlPin, state);
+}
+
+template <typename Board>
+void HardwareInterface<Board>::applyOutputs() {
+#if PWM_ENGINE_AVAILABLE
+    PwmEngine::commit();
+#endif
+}
+
+// Input reading
+template <typename Board>
+int HardwareInterface<Board>::readFlameSensor() {
+    return readAnalog(Board::flameSensePin);
+}
+
+template <typename Board>
+int HardwareInterface<Board>::readSurfaceSensor() {
+    return readAnalog(Board::surfaceSensePin);
+}
+
+template <typename Board>
+int HardwareInterface<Board>::readOvertempSensor() {
+    return readAnalog(Board::overtempSensePin);
+}
+
+// Current sensing
+template <typename Board>
+int HardwareInterface<Board>::readFanCurrent() {
+    return readAnalog(Board::fanCurrentSensePin);
+}
+
+template <typename Board>
+int HardwareInterface<Board>::readGlowCurrent() {
+    return readAnalog(Board::glowCurrentSensePin);
+}
+
+template <typename Board>
+int HardwareInterface<Board>::readWaterPumpCurrent() {
+    return readAnalog(Board::waterPumpCurrentSensePin);
+}
+
+// A reading outside half to twice the nominal supply is an unfitted divider
+// or an open pin, not a battery, so the nominal value stands in for it
+template <typename Board>
+uint16_t HardwareInterface<Board>::readSupplyMillivolts() {
+    if (Board::supplySensePin == NO_PIN) return Board::nominalSupplyMillivolts;
+    uint32_t millivolts = static_cast<uint32_t>(analogRead(Board::supplySensePin)) * Board::supplyFullScaleMillivolts / 1024;
+    if (millivolts < Board::nominalSupplyMillivolts / 2U || millivolts > Board::nominalSupplyMillivolts * 2UL) {
+        return Board::nominalSupplyMillivolts;
+    }
+    return static_cast<uint16_t>(millivolts);
+}
+
+// Get water temperature
+template <typename Board>
+int HardwareInterface<Board>::getWaterTemp() {
+    return interpolate(readSurfaceSensor(), Board::waterTempMapping);
+}
+
+// Get flame temperature
+template <typename Board>
+int HardwareInterface<Board>::getFlameTemp() {
+    return interpolate(readFlameSensor(), Board::flameTempMapping);
+}
+
+// Get over-temperature value
+template <typename Board>
+int HardwareInterface<Board>::getOverTemp() {
+    return interpolate(readOvertempSensor(), Board::overTempMapping);
+}
+
+// Pin helpers
+template <typename Board>
+void HardwareInterface<Board>::initOutput(uint8_t pin) {
+    if (pin == NO_PIN) return;
+    pinMode(pin, OUTPUT);
+    digitalWrite(pin, LOW);
+}
+
+template <typename Board>
+void HardwareInterface<Board>::writeDigital(uint8_t pin, bool state) {
+    if (pin == NO_PIN) return;
+    digitalWrite(pin, state ? HIGH : LOW);
+}
+
+template <typename Board>
+int HardwareInterface<Board>::readAnalog(uint8_t pin) {
+    if (pin == NO_PIN) return 0;
+    return analogRead(pin);
+}
+
+// PwmEngine channel if the pin has one, otherwise 8-bit analogWrite(). A
+// proportional output on a pin without PWM does not build: switching it
+// fully on would, for the glow plug, put the whole supply across it.
+template <typename Board>
+template <uint8_t Pin>
+void HardwareInterface<Board>::writeDuty(uint16_t duty) {
+    if constexpr (Pin == NO_PIN) {
+        return;
+    } else if constexpr (PwmEngine::channelFor(Pin) != PwmEngine::NONE) {
+        PwmEngine::setDuty(PwmEngine::channelFor(Pin), duty);
+    } else {
+        static_assert(digitalPinHasPWM(Pin), "Proportional output on a pin with no PWM channel");
+        analogWrite(Pin, duty >> 8);
+    }
+}
+
+// Interpolation function with extrapolation
+template <typename Board>
+template <size_t N>
+int HardwareInterface<Board>::interpolate(int rawValue, const VoltageTempMapping (&mapping)[N]) {
+    static_assert(N >= 2, "Mapping needs at least two points");
+
+    for (size_t i = 0; i < N - 1; i++) {
+        int x1 = mapping[i].voltage;
+        int y1 = mapping[i].temperature;
+        int x2 = mapping[i + 1].voltage;
+        int y2 = mapping[i + 1].temperature;
+
+        // Check if rawValue is within the current range
+        if (rawValue >= x1 && rawValue <= x2) {
+            // Linear interpolation formula
+            return y1 + (y2 - y1) * (rawValue - x1) / (x2 - x1);
+        }
+    }
+
+    // Extrapolate before the first point
+    if (rawValue < mapping[0].voltage) {
+        int x1 = mapping[0].voltage;
+        int y1 = mapping[0].temperature;
+        int x2 = mapping[1].voltage;
+        int y2 = mapping[1].temperature;
+        return y1 + (y2 - y1) * (rawValue - x1) / (x2 - x1);
+    }
+
+    // Extrapolate after the last point
+    if (rawValue > mapping[N - 1].voltage) {
+        int x1 = mapping[N - 2].voltage;
+        int y1 = mapping[N - 2].temperature;
+        int x2 = mapping[N - 1].voltage;
+        int y2 = mapping[N - 1].temperature;
+        return y1 + (y2 - y1) * (rawValue - x1) / (x2 - x1);
+    }
+
+    return 0; // Default fallback
+}
+
 #endif // HARDWARE_INTERFACE_H
@@ -0,0 +1,49 @@
+#ifndef POWER_CONTROLLER_H
+#define POWER_CONTROLLER_H
+
+#include <stdint.h>
+
+// Fixed-point PI controller for modulating burner power, integer-only so it
+// is cheap on the AVR. Power is a 16-bit fraction of the way along the
+// operating line from the SMALL point (0) to the LARGE point (FULL).
+//
+// It runs in velocity form: each update adds Kp * (change in error) plus
+// Ki * error * dt to the previous output, and the output is clamped. There
+// is no separate integrator to wind up while the burner is at a limit, and
+// the output can be preset for a bumpless hand-over.
+class PowerController {
+public:
+    static constexpr int32_t FULL = 65535;
+
+    // kp: power per degree C; ki: power per degree C per second (both Q16)
+    PowerController(int32_t kp, int32_t ki) : kp(kp), ki(ki), output(0), lastError(0) {}
+
+    // Start from a known power, e.g. FULL after the start sequence
+    void reset(int32_t power, int error) {
+        output = clamp(power);
+        lastError = error;
+    }
+
+    // One control step; error is setpoint minus measurement in degrees C
+    int32_t update(int error, unsigned long dtMs) {
+        if (dtMs > 10000) dtMs = 10000;   // Keep the product within 32 bits
+        int32_t delta = kp * (error - lastError) + ki * error * static_cast<int32_t>(dtMs) / 1000;
+        lastError = error;
+        output = clamp(output + delta);
+        return output;
+    }
+
+    int32_t power() const { return output; }
+
+private:
+    int32_t kp;
+    int32_t ki;
+    int32_t output;
+    int lastError;
+
+    static int32_t clamp(int32_t value) {
+        return value < 0 ? 0 : value > FULL ? FULL : value;
+    }
+};
+
+#endif // POWER_CONTROLLER_H
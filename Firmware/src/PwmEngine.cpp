@@ -0,0 +1,325 @@
+#include "PwmEngine.h"
+
+#if PWM_ENGINE_AVAILABLE
+
+#include <avr/interrupt.h>
+#include <util/atomic.h>
+
+uint16_t PwmEngine::timer1Top = 0;
+uint8_t PwmEngine::timer2Top = 0;
+volatile uint16_t PwmEngine::stagedTimer1A = 0;
+volatile uint16_t PwmEngine::stagedTimer1B = 0;
+volatile uint8_t PwmEngine::stagedTimer2B = 0;
+volatile uint8_t PwmEngine::stagedEnable = 0;
+
+// Scale a 16-bit duty onto 0..top
+static uint16_t scaleDuty(uint16_t duty, uint16_t top) {
+    return static_cast<uint16_t>((static_cast<uint32_t>(duty) * (static_cast<uint32_t>(top) + 1)) >> 16);
+}
+
+// Timer1 TOP for a frequency, no prescaler unless it is too low for 16 bits
+static uint8_t timer1Clock(uint32_t hz, uint16_t& top) {
+    uint32_t counts = F_CPU / hz;
+    uint8_t clockSelect = _BV(CS10);
+    if (counts > 65536UL) {
+        counts /= 8;
+        clockSelect = _BV(CS11);
+    }
+    top = static_cast<uint16_t>(counts - 1);
+    return clockSelect;
+}
+
+#if defined(__AVR_ATmega328P__)
+
+// Timer2 clock select bits for each available prescaler
+static const uint16_t timer2Prescalers[] = {1, 8, 32, 64, 128, 256, 1024};
+
+void PwmEngine::init(uint32_t motorHz, uint32_t glowHz) {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        // Timer1: mode 14, fast PWM with TOP = ICR1
+        uint8_t clockSelect = timer1Clock(motorHz, timer1Top);
+
+        TCCR1B = 0;
+        TCCR1A = _BV(WGM11);
+        TCNT1 = 0;
+        ICR1 = timer1Top;
+        OCR1A = 0;
+        OCR1B = 0;
+        TIMSK1 &= ~_BV(TOIE1);
+        TCCR1B = _BV(WGM13) | _BV(WGM12) | clockSelect;
+
+        // Timer2: mode 7, fast PWM with TOP = OCR2A; smallest prescaler
+        // that fits the period in 8 bits
+        uint8_t select = 0;
+        uint32_t counts = F_CPU / glowHz;
+        while (select < 6 && counts / timer2Prescalers[select] > 256) select++;
+        counts /= timer2Prescalers[select];
+        timer2Top = static_cast<uint8_t>(counts > 256 ? 255 : counts - 1);
+
+        TCCR2B = 0;
+        TCCR2A = _BV(WGM21) | _BV(WGM20);
+        TCNT2 = 0;
+        OCR2A = timer2Top;
+        OCR2B = 0;
+        TCCR2B = _BV(WGM22) | (select + 1);
+
+        stagedEnable = 0;
+    }
+}
+
+void PwmEngine::setDuty(Channel channel, uint16_t duty) {
+    // Hold off a pending load while the 16-bit staged values change
+    TIMSK1 &= ~_BV(TOIE1);
+
+    uint8_t bit = _BV(channel);
+    if (duty == 0) {
+        stagedEnable &= ~bit;
+    } else {
+        stagedEnable |= bit;
+    }
+
+    switch (channel) {
+        case TIMER1_A:
+            stagedTimer1A = duty == 0xFFFF ? timer1Top : scaleDuty(duty, timer1Top);
+            break;
+        case TIMER1_B:
+            stagedTimer1B = duty == 0xFFFF ? timer1Top : scaleDuty(duty, timer1Top);
+            break;
+        case TIMER2_B:
+            stagedTimer2B = duty == 0xFFFF ? timer2Top : static_cast<uint8_t>(scaleDuty(duty, timer2Top));
+            break;
+        default:
+            break;
+    }
+}
+
+void PwmEngine::commit() {
+    // Load after the next TOP, not on a flag left over from earlier periods
+    TIFR1 = _BV(TOV1);
+    TIMSK1 |= _BV(TOIE1);
+}
+
+uint16_t PwmEngine::steps(Channel channel) {
+    switch (channel) {
+        case TIMER1_A:
+        case TIMER1_B:
+            return timer1Top + 1;
+        case TIMER2_B:
+            return timer2Top + 1;
+        default:
+            return 0;
+    }
+}
+
+// Runs just after TOP; the compare registers are themselves double-buffered
+// and take these values together at the next BOTTOM
+void PwmEngine::loadStaged() {
+    uint8_t enable = stagedEnable;
+
+    OCR1A = stagedTimer1A;
+    OCR1B = stagedTimer1B;
+    TCCR1A = _BV(WGM11)
+           | (enable & _BV(TIMER1_A) ? _BV(COM1A1) : 0)
+           | (enable & _BV(TIMER1_B) ? _BV(COM1B1) : 0);
+
+    OCR2B = stagedTimer2B;
+    TCCR2A = _BV(WGM21) | _BV(WGM20) | (enable & _BV(TIMER2_B) ? _BV(COM2B1) : 0);
+
+    // One load per commit
+    TIMSK1 &= ~_BV(TOIE1);
+}
+
+ISR(TIMER1_OVF_vect) {
+    PwmEngine::loadStaged();
+}
+
+#elif defined(__AVR_ATmega32U4__)
+
+// Shortest high time, so the OCR1A match still lies ahead of the counter
+// once the period interrupt has run
+static const uint16_t MIN_SOFT_COUNTS = 256;
+
+// D12 output: off, low on the OCR1A match, or high all period
+enum SoftMode : uint8_t { SOFT_OFF, SOFT_PWM, SOFT_FULL };
+static volatile uint8_t stagedMode = SOFT_OFF;
+static volatile bool loadPending = false;
+static uint8_t activeMode = SOFT_OFF;
+
+// Dosing pump strokes: a 32-bit phase advanced every period, one stroke per
+// wrap, so the average rate is exact whatever the period
+static uint32_t phasePerStrokeHour = 0;     // Phase step per period at 1 stroke/h
+static uint16_t periodHz = 0;
+static volatile uint32_t stagedStrokeStep = 0;
+static volatile uint8_t stagedPulsePeriods = 0;
+static uint32_t strokeStep = 0;
+static uint32_t strokePhase = 0;
+static uint8_t pulsePeriods = 0;
+static uint8_t pulseLeft = 0;
+
+// Fan on OC4D. Timer4 double-buffers OCR4D itself and takes the new value
+// up at TOP; TC4H carries bits 8-9 of every 10-bit access.
+static uint16_t timer4Top = 0;
+static volatile uint16_t stagedTimer4D = 0;
+
+// Timer4 TOP for a frequency: the smallest power-of-two prescaler (clock
+// select n divides by 2^(n-1)) that fits the period in 10 bits
+static uint8_t timer4Clock(uint32_t hz, uint16_t& top) {
+    uint32_t counts = F_CPU / hz;
+    uint8_t clockSelect = _BV(CS40);
+    while (counts > 1024 && clockSelect < 15) {
+        counts /= 2;
+        clockSelect++;
+    }
+    top = static_cast<uint16_t>(counts > 1024 ? 1023 : counts - 1);
+    return clockSelect;
+}
+
+void PwmEngine::init(uint32_t motorHz, uint32_t glowHz) {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        // Timer4: fast PWM with TOP = OCR4C, OC4D only, clocked from the
+        // system clock rather than the USB PLL
+        uint8_t clock4 = timer4Clock(motorHz, timer4Top);
+
+        TCCR4B = 0;
+        PLLFRQ &= ~(_BV(PLLTM1) | _BV(PLLTM0));
+        TCCR4A = 0;
+        TCCR4C = _BV(PWM4D);
+        TCCR4D = 0;
+        TCCR4E = 0;
+        TC4H = 0;
+        TCNT4 = 0;
+        TC4H = timer4Top >> 8;
+        OCR4C = timer4Top & 0xFF;
+        TC4H = 0;
+        OCR4D = 0;
+        TCCR4B = clock4;
+        stagedTimer4D = 0;
+        stagedEnable = 0;
+
+        // Timer1: mode 12, CTC with TOP = ICR1. OCR1A is not buffered in
+        // CTC, so the period interrupt can set this period's match.
+        uint8_t clockSelect = timer1Clock(glowHz, timer1Top);
+
+        TCCR1B = 0;
+        TCCR1A = 0;
+        TCNT1 = 0;
+        ICR1 = timer1Top;
+        OCR1A = timer1Top;
+        TIFR1 = _BV(ICF1) | _BV(OCF1A);
+        TIMSK1 = _BV(ICIE1);
+        TCCR1B = _BV(WGM13) | _BV(WGM12) | clockSelect;
+
+        PORTD &= ~(_BV(PD6) | _BV(PD1));
+        activeMode = SOFT_OFF;
+        stagedMode = SOFT_OFF;
+        periodHz = static_cast<uint16_t>(glowHz);
+        phasePerStrokeHour = 0xFFFFFFFFUL / (3600UL * glowHz);
+        stagedStrokeStep = strokeStep = 0;
+        stagedPulsePeriods = pulsePeriods = 0;
+        strokePhase = 0;
+        pulseLeft = 0;
+        loadPending = false;
+    }
+}
+
+void PwmEngine::setDuty(Channel channel, uint16_t duty) {
+    if (channel == TIMER4_D) {
+        uint16_t counts = duty == 0xFFFF ? timer4Top : scaleDuty(duty, timer4Top);
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+            loadPending = false;
+            stagedTimer4D = counts;
+            if (duty == 0) {
+                stagedEnable &= ~_BV(TIMER4_D);
+            } else {
+                stagedEnable |= _BV(TIMER4_D);
+            }
+        }
+        return;
+    }
+    if (channel != TIMER1_D12) return;
+
+    uint16_t counts = scaleDuty(duty, timer1Top);
+    if (counts < MIN_SOFT_COUNTS) counts = MIN_SOFT_COUNTS;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        loadPending = false;
+        stagedTimer1A = counts;
+        stagedMode = duty == 0 ? SOFT_OFF : duty == 0xFFFF ? SOFT_FULL : SOFT_PWM;
+    }
+}
+
+void PwmEngine::setStrokeRate(uint16_t strokesPerHour, uint16_t pulseMillis) {
+    uint32_t periods = (static_cast<uint32_t>(pulseMillis) * periodHz + 500) / 1000;
+    if (periods < 1) periods = 1;
+    if (periods > 255) periods = 255;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        loadPending = false;
+        stagedStrokeStep = strokesPerHour * phasePerStrokeHour;
+        stagedPulsePeriods = static_cast<uint8_t>(periods);
+    }
+}
+
+void PwmEngine::commit() {
+    loadPending = true;
+}
+
+uint16_t PwmEngine::steps(Channel channel) {
+    switch (channel) {
+        case TIMER1_D12:
+            return timer1Top + 1;
+        case TIMER4_D:
+            return timer4Top + 1;
+        default:
+            return 0;
+    }
+}
+
+void PwmEngine::loadStaged() {
+    activeMode = stagedMode;
+    OCR1A = stagedTimer1A;
+    TC4H = stagedTimer4D >> 8;
+    OCR4D = stagedTimer4D & 0xFF;
+    TCCR4C = _BV(PWM4D) | (stagedEnable & _BV(TIMER4_D) ? _BV(COM4D1) : 0);
+    strokeStep = stagedStrokeStep;
+    pulsePeriods = stagedPulsePeriods;
+    loadPending = false;
+}
+
+// Runs at the start of every period
+void PwmEngine::startPeriod() {
+    if (loadPending) loadStaged();
+
+    TIFR1 = _BV(OCF1A);
+    if (activeMode == SOFT_OFF) {
+        PORTD &= ~_BV(PD6);
+        TIMSK1 &= ~_BV(OCIE1A);
+    } else {
+        PORTD |= _BV(PD6);
+        if (activeMode == SOFT_PWM) {
+            TIMSK1 |= _BV(OCIE1A);
+        } else {
+            TIMSK1 &= ~_BV(OCIE1A);
+        }
+    }
+
+    if (pulseLeft != 0 && --pulseLeft == 0) PORTD &= ~_BV(PD1);
+    uint32_t phase = strokePhase + strokeStep;
+    if (phase < strokePhase && pulseLeft == 0 && pulsePeriods != 0) {
+        PORTD |= _BV(PD1);
+        pulseLeft = pulsePeriods;
+    }
+    strokePhase = phase;
+}
+
+ISR(TIMER1_CAPT_vect) {
+    PwmEngine::startPeriod();
+}
+
+ISR(TIMER1_COMPA_vect) {
+    PORTD &= ~_BV(PD6);
+}
+
+#endif
+
+#endif // PWM_ENGINE_AVAILABLE
@@ -0,0 +1,102 @@
+#ifndef PWM_ENGINE_H
+#define PWM_ENGINE_H
+
+#include <Arduino.h>
+
+#if defined(__AVR_ATmega328P__) || defined(__AVR_ATmega32U4__)
+#define PWM_ENGINE_AVAILABLE 1
+#else
+#define PWM_ENGINE_AVAILABLE 0
+#endif
+
+// Actuator PWM that leaves Timer0 to millis().
+//
+// ATmega328P: Timer1 runs fast PWM with ICR1 as TOP, so its two outputs get
+// F_CPU / f steps (800 at 20 kHz, 1024 at 15.6 kHz); Timer2 uses OCR2A as
+// TOP and drives OC2B only.
+//
+// ATmega32U4: the D5S fan on D6 (PD7) is OC4D of the 10-bit Timer4, run in
+// fast PWM with OCR4C as TOP (800 steps at 20 kHz, 1024 at 15.6 kHz). The
+// glow output is D12 (PD6). That is /OC4D, tied to the fan's OCR4D, so
+// Timer1 runs CTC with ICR1 as TOP and switches the pin from its interrupts
+// instead: high at the start of each period, low on the OCR1A match. The
+// same period interrupt times dosing pump strokes on D2 (PD1), which has no
+// timer output at all.
+//
+// Duties are 16-bit fractions of full scale (0xFFFF = always on) and are
+// scaled to the resolution the chosen frequency leaves. setDuty() only
+// stages a value; commit() has the next Timer1 period load every staged
+// value together, so outputs never see a half-applied update. Zero duty
+// disconnects the output for a clean low.
+class PwmEngine {
+public:
+    enum Channel : uint8_t {
+        TIMER1_A,   // OC1A, D9 (328P)
+        TIMER1_B,   // OC1B, D10 (328P)
+        TIMER2_B,   // OC2B, D3 (328P)
+        TIMER1_D12, // PD6 switched by Timer1 interrupts (32U4)
+        TIMER4_D,   // OC4D, D6 (32U4)
+        NONE
+    };
+
+    // Channel driven from an Arduino pin, or NONE if the pin has no channel
+    static constexpr Channel channelFor(uint8_t pin) {
+#if defined(__AVR_ATmega328P__)
+        return pin == 9 ? TIMER1_A
+             : pin == 10 ? TIMER1_B
+             : pin == 3 ? TIMER2_B
+             : NONE;
+#elif defined(__AVR_ATmega32U4__)
+        return pin == 12 ? TIMER1_D12
+             : pin == 6 ? TIMER4_D
+             : NONE;
+#else
+        (void)pin;
+        return NONE;
+#endif
+    }
+
+    // Whether the dosing pump stroke output is on this pin
+    static constexpr bool strokesOn(uint8_t pin) {
+#if defined(__AVR_ATmega32U4__)
+        return pin == 2;
+#else
+        (void)pin;
+        return false;
+#endif
+    }
+
+    // Starts the timers with all outputs off. The 328P runs Timer1 at
+    // motorHz and Timer2 at glowHz; the 32U4 runs Timer4 at motorHz and
+    // Timer1 at glowHz.
+    static void init(uint32_t motorHz, uint32_t glowHz);
+
+    // Stage a duty for the next commit()
+    static void setDuty(Channel channel, uint16_t duty);
+
+    // Stage a dosing pump rate for the next commit(): strokesPerHour pulses
+    // of pulseMillis each, spread evenly. A stroke that falls due while the
+    // previous pulse is still on is skipped, so keep the rate below one
+    // stroke per two pulse widths.
+    static void setStrokeRate(uint16_t strokesPerHour, uint16_t pulseMillis);
+
+    // Apply all staged values at the start of the next Timer1 period
+    static void commit();
+
+    // Number of distinct duty steps on a channel at the configured frequency
+    static uint16_t steps(Channel channel);
+
+    // Called from the Timer1 interrupts
+    static void loadStaged();
+    static void startPeriod();
+
+private:
+    static uint16_t timer1Top;
+    static uint8_t timer2Top;
+    static volatile uint16_t stagedTimer1A;
+    static volatile uint16_t stagedTimer1B;
+    static volatile uint8_t stagedTimer2B;
+    static volatile uint8_t stagedEnable;   // Bit per channel, clear = output off
+};
+
+#endif // PWM_ENGINE_H
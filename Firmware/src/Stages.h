@@ -1,7 +1,7 @@
 #ifndef STAGES_H
 #define STAGES_H
 
-#include "StateMachine.h"
+// Included from StateMachine.h once the Stage type is declared
 
 #define FAN_SPEED_OFF 0
 #define FAN_SPEED_VERY_SMALL 20
@@ -14,16 +14,22 @@
 #define FUEL_PUMP_MEDIUM 480
 #define FUEL_PUMP_HIGH 620  
 
-#define GLOW_VOLTS_ON 8.2       // Volts
-#define GLOW_VOLTS_OFF 0
+#define GLOW_MILLIVOLTS_ON 8200 // RMS across the plug
+#define GLOW_MILLIVOLTS_OFF 0
 
 #define LARGE_TO_SMALL_THRESHOLD 85
 #define SMALL_TO_LARGE_THRESHOLD 72
 #define OVERTEMP_THRESHOLD 90
 
+// Modulating mode: one PI loop between the SMALL and LARGE operating points
+#define POWER_MODULATION true
+#define WATER_TEMP_SETPOINT 78  // Middle of the SMALL/LARGE band
+#define MODULATION_KP 6554      // 10% power per degree C (Q16)
+#define MODULATION_KI 66        // 0.1% power per degree C per second (Q16)
+
 
 // Define shutdown stages
-Stage shutdownStages[] = {
+const Stage shutdownStages[] = {
     {
         .message = "SHUTDOWN: Stage 1",
         .duration = 10.0,
@@ -67,7 +73,7 @@ Stage shutdownStages[] = {
 };
 
 // Define start stages
-Stage startStages[] = {
+const Stage startStages[] = {
     {
         .message = "START: Stage 1 (0)",
         .duration = 5.0,
@@ -161,7 +167,7 @@ Stage startStages[] = {
     {
         .message = "START: Stage 10 (120)",
         .duration = 10.0,
-        .condition = &StateMachine::largeCondition,
+        .condition = &largeCondition,
         .waterPumpState = true,
         .blowerState = true,
         .glowState = false,
@@ -171,7 +177,7 @@ Stage startStages[] = {
 };
 
 // Define transition from large to small
-Stage smallStages[] = {
+const Stage smallStages[] = {
     {
         .message = "SMALL: Stage 1 - Reducing power.",
         .duration = 5.0,
@@ -185,7 +191,7 @@ Stage smallStages[] = {
     {
         .message = "SMALL: Stage 2 - Low power.",
         .duration = 60.0,
-        .condition = &StateMachine::smallCondition,
+        .condition = &smallCondition,
         .waterPumpState = true,
         .blowerState = false,
         .glowState = false,
@@ -195,7 +201,7 @@ Stage smallStages[] = {
 };
 
 // Define transition from small to large
-Stage largeStages[] = {
+const Stage largeStages[] = {
     {
         .message = "LARGE: Stage 1 - Increasing power.",
         .duration = 5.0,
@@ -209,7 +215,7 @@ Stage largeStages[] = {
     {
         .message = "LARGE: Stage 2 - Full Power.",
         .duration = 60.0,
-        .condition = &StateMachine::largeCondition,
+        .condition = &largeCondition,
         .waterPumpState = true,
         .blowerState = false,
         .glowState = false,
@@ -1,8 +1,19 @@
 #ifndef STATEMACHINE_H
 #define STATEMACHINE_H
 
-#include <Arduino.h>
-#include "HardwareInterface.h"
+#include <stdint.h>
+
+#include "PowerController.h"
+
+// Define state names
+enum State {
+    IDLE,
+    START,
+    LARGE,  // Renamed from HIGH
+    SMALL,  // Renamed from LOW
+    SHUTDOWN,
+    MODULATING  // Replaces LARGE/SMALL when power modulation is on
+};
 
 // Define a range structure for analog signals
 struct Range {
@@ -14,7 +25,7 @@ struct Range {
 struct Stage {
     const char* message;
     float duration;
-    State (*condition)();  // Returns the next state
+    State (*condition)(int waterTemp);  // Returns the next state
     bool waterPumpState;
     bool blowerState;
     bool glowState;
@@ -22,36 +33,81 @@ struct Stage {
     Range fuelPump;
 };
 
+// Helper functions for conditions
+inline State largeCondition(int waterTemp);
+inline State smallCondition(int waterTemp);
 
-// Define state names
-enum State {
-    IDLE,
-    START,
-    LARGE,  // Renamed from HIGH
-    SMALL,  // Renamed from LOW
-    SHUTDOWN
-};
+#include "Stages.h"
+
+inline State largeCondition(int waterTemp) {
+    if (waterTemp > OVERTEMP_THRESHOLD) {
+        return State::SHUTDOWN;
+    } else if (waterTemp > LARGE_TO_SMALL_THRESHOLD) {
+        return State::SMALL;
+    }
+    return State::LARGE;
+}
+
+inline State smallCondition(int waterTemp) {
+    if (waterTemp > OVERTEMP_THRESHOLD) {
+        return State::SHUTDOWN;
+    } else if (waterTemp < SMALL_TO_LARGE_THRESHOLD) {
+        return State::LARGE;
+    }
+    return State::SMALL;
+}
+
+// Linear interpolation helper
+inline long linearInterpolate(long start, long end, unsigned long elapsedTime, unsigned long duration) {
+    float progress = static_cast<float>(elapsedTime) / (duration * 1000);
+    if (progress > 1.0) progress = 1.0; // Clamp progress
+    return start + static_cast<long>((end - start) * progress);
+}
+
+// Modulating operating line: power 0 is the SMALL point, FULL the LARGE point
+inline uint16_t operatingFanDuty(int32_t power) {
+    uint32_t span = static_cast<uint32_t>(FAN_SPEED_LARGE - FAN_SPEED_SMALL) * 257U;
+    return FAN_SPEED_SMALL * 257U + static_cast<uint16_t>((span * power + 0x8000) >> 16);
+}
 
+inline uint16_t operatingFuelRate(int32_t power) {
+    int32_t span = FUEL_PUMP_HIGH - FUEL_PUMP_LOW;
+    return FUEL_PUMP_LOW + static_cast<uint16_t>((span * power + 0x8000) >> 16);
+}
+
+// The hardware layer is a template parameter: on the AVR it is
+// HardwareInterface<ActiveBoard> and every call inlines. Host-side mocks and
+// simulators only need the methods used below, plus millis(), log() and
+// maxFuelRate.
+template <typename Hardware>
 class StateMachine {
+    static_assert(Hardware::maxFuelRate >= FUEL_PUMP_HIGH, "Fuel pump drive cannot reach FUEL_PUMP_HIGH");
+
 private:
-    HardwareInterface& hardware;      // Reference to the hardware interface
+    Hardware& hardware;               // Reference to the hardware interface
     State currentState;               // Current state of the state machine
     unsigned long stageStartTime;     // Time when the current stage started
     int currentStageIndex;            // Current stage index within the state
-    Stage* currentStages;             // Pointer to the stages of the current state
+    bool stageHeld;                   // Final stage kept on by its condition
+    const Stage* currentStages;       // Pointer to the stages of the current state
     int totalStages;                  // Total number of stages in the current state
     State nextState;                  // Next state to transition to
     bool runSignal;                   // Control signal for RUN
+    const Stage* startSequence;       // Stages run in START
+    int startSequenceCount;           // Number of start stages
+    bool modulation;                  // Run MODULATING instead of LARGE/SMALL
+    PowerController controller;       // Water temperature loop for MODULATING
+    unsigned long lastControlTime;    // Time of the last controller update
 
     // Helper methods
     void resetHandler(State state);   // Reset stages and setup for a given state
     void tickHandler();               // Tick through the current stage logic
-
-
+    void modulateHandler();           // Closed-loop power control
+    State runState(State state) const; // Maps LARGE/SMALL to MODULATING when enabled
 
 public:
     // Constructor
-    StateMachine(HardwareInterface& hw);
+    StateMachine(Hardware& hw);
 
     // Initialization
     void init();
@@ -59,15 +115,209 @@ public:
     // Control signal setters
     void setRunSignal(bool run);      // Set the RUN signal
 
+    // Replace the start sequence (defaults to startStages), e.g. for tuning
+    void setStartStages(const Stage* stages, int count);
+
+    // Choose modulating power control or LARGE/SMALL stages after START
+    void setModulation(bool enabled) { modulation = enabled; }
+
     // State machine tick
     void tick();                      // Perform the state machine logic on each loop
 
     // Getters for current state
     State getCurrentState() const { return currentState; }
-
-    // Helper functions for conditions
-    static State largeCondition();
-    static State smallCondition();
 };
 
+// Constructor
+template <typename Hardware>
+StateMachine<Hardware>::StateMachine(Hardware& hw) : hardware(hw), currentState(IDLE), stageStartTime(0), currentStageIndex(0), stageHeld(false),
+                                                     currentStages(nullptr), totalStages(0), nextState(IDLE),
+                                                     runSignal(false), startSequence(startStages),
+                                                     startSequenceCount(startStagesCount), modulation(POWER_MODULATION),
+                                                     controller(MODULATION_KP, MODULATION_KI), lastControlTime(0) {
+}
+
+// Initialize the state machine
+template <typename Hardware>
+void StateMachine<Hardware>::init() {
+    resetHandler(IDLE);
+}
+
+// Set the RUN signal
+template <typename Hardware>
+void StateMachine<Hardware>::setRunSignal(bool run) {
+    if (runSignal != run) {
+        runSignal = run;
+        if (!runSignal && currentState != SHUTDOWN) {
+            currentState = SHUTDOWN;
+            resetHandler(SHUTDOWN);
+        }
+    }
+}
+
+// Replace the start sequence
+template <typename Hardware>
+void StateMachine<Hardware>::setStartStages(const Stage* stages, int count) {
+    startSequence = stages;
+    startSequenceCount = count;
+}
+
+// Tick the state machine
+template <typename Hardware>
+void StateMachine<Hardware>::tick() {
+    if (currentState == IDLE && runSignal) {
+        currentState = START;
+        resetHandler(START);
+    }
+
+    if (currentState == MODULATING) {
+        modulateHandler();
+    } else {
+        tickHandler();
+    }
+}
+
+// Use the modulating controller in place of the LARGE/SMALL stages
+template <typename Hardware>
+State StateMachine<Hardware>::runState(State state) const {
+    return modulation && (state == LARGE || state == SMALL) ? MODULATING : state;
+}
+
+// Reset the stage handler for a given state
+template <typename Hardware>
+void StateMachine<Hardware>::resetHandler(State state) {
+    switch (state) {
+        case SHUTDOWN:
+            currentStages = shutdownStages;
+            totalStages = shutdownStagesCount;
+            nextState = IDLE;
+            break;
+        case START:
+            currentStages = startSequence;
+            totalStages = startSequenceCount;
+            nextState = LARGE; // Transition to LARGE after START
+            break;
+        case LARGE: // Renamed from HIGH
+            currentStages = largeStages;
+            totalStages = largeStagesCount;
+            nextState = SMALL; // Transition to SMALL
+            break;
+        case SMALL: // Renamed from LOW
+            currentStages = smallStages;
+            totalStages = smallStagesCount;
+            nextState = LARGE; // Transition to LARGE
+            break;
+        case MODULATING:
+            // Bumpless from the end of START, which finishes at the LARGE point
+            currentStages = nullptr;
+            totalStages = 0;
+            nextState = SHUTDOWN;
+            controller.reset(PowerController::FULL, WATER_TEMP_SETPOINT - hardware.getWaterTemp());
+            lastControlTime = hardware.millis();
+            break;
+        default:
+            currentStages = nullptr;
+            totalStages = 0;
+            break;
+    }
+    currentStageIndex = 0;
+    stageHeld = false;
+    stageStartTime = hardware.millis();
+}
+
+template <typename Hardware>
+void StateMachine<Hardware>::tickHandler() {
+    if (currentStageIndex >= totalStages) {
+        // Transition to the next state
+        currentState = runState(nextState);
+        resetHandler(currentState);
+        return;
+    }
+
+    const Stage& currentStage = currentStages[currentStageIndex];
+
+    // Log the stage message
+    hardware.log(currentStage.message);
+
+    // Set digital states via hardware abstraction
+    hardware.setWaterPumpState(currentStage.waterPumpState);
+    hardware.setBlowerState(currentStage.blowerState);
+    hardware.setGlowVoltage(currentStage.glowState ? GLOW_MILLIVOLTS_ON : GLOW_MILLIVOLTS_OFF);
+
+    // Calculate elapsed time; a held stage stays at the end of its ramp
+    unsigned long elapsedTime = hardware.millis() - stageStartTime;
+    unsigned long rampTime = stageHeld ? static_cast<unsigned long>(currentStage.duration * 1000) : elapsedTime;
+
+    // Interpolate analog values; the fan ramps at full PWM resolution
+    uint16_t interpolatedFanDuty = static_cast<uint16_t>(linearInterpolate(currentStage.fanSpeed.start * 257L, currentStage.fanSpeed.end * 257L, rampTime, currentStage.duration));
+    int interpolatedFanSpeed = interpolatedFanDuty / 257;
+    uint16_t interpolatedFuelRate = static_cast<uint16_t>(linearInterpolate(currentStage.fuelPump.start, currentStage.fuelPump.end, rampTime, currentStage.duration));
+
+    // Write interpolated values to hardware
+    hardware.setFanDuty(interpolatedFanDuty);
+    hardware.setFuelRate(interpolatedFuelRate);
+    hardware.applyOutputs();
+
+    // Log interpolated values
+    hardware.log("Fan Speed: ", interpolatedFanSpeed);
+    hardware.log("Fuel Pump: ", interpolatedFuelRate);
+
+    // Check if the stage is complete
+    if (elapsedTime >= currentStage.duration * 1000) {
+        currentStageIndex++;
+        stageStartTime = hardware.millis();
+
+        // Final stage logic
+        if (currentStageIndex >= totalStages) {
+            State transitionState = runState(currentStage.condition ? currentStage.condition(hardware.getWaterTemp()) : nextState);
+
+            // Handle state transition
+            if (transitionState != currentState) {
+                hardware.log("Transitioning to next state.");
+                currentState = transitionState;
+                resetHandler(currentState);
+            } else {
+                // Condition says stay: hold the final stage at its end
+                // values and check again after its duration rather than
+                // falling through to nextState
+                currentStageIndex = totalStages - 1;
+                stageHeld = true;
+            }
+        }
+    }
+}
+
+// Closed-loop power control, every tick
+template <typename Hardware>
+void StateMachine<Hardware>::modulateHandler() {
+    int waterTemp = hardware.getWaterTemp();
+    if (waterTemp > OVERTEMP_THRESHOLD) {
+        hardware.log("Transitioning to next state.");
+        currentState = SHUTDOWN;
+        resetHandler(SHUTDOWN);
+        return;
+    }
+
+    unsigned long now = hardware.millis();
+    int32_t previousPower = controller.power();
+    int32_t power = controller.update(WATER_TEMP_SETPOINT - waterTemp, now - lastControlTime);
+    lastControlTime = now;
+
+    // Air leads fuel: on the way up the fan is already at the new point, on
+    // the way down it holds the previous one for a tick
+    uint16_t fanDuty = operatingFanDuty(power > previousPower ? power : previousPower);
+    uint16_t fuelRate = operatingFuelRate(power);
+
+    hardware.setWaterPumpState(true);
+    hardware.setBlowerState(false);
+    hardware.setGlowVoltage(GLOW_MILLIVOLTS_OFF);
+    hardware.setFanDuty(fanDuty);
+    hardware.setFuelRate(fuelRate);
+    hardware.applyOutputs();
+
+    hardware.log("MODULATING: Water Temp: ", waterTemp);
+    hardware.log("Fan Speed: ", (fanDuty + 128) / 257);
+    hardware.log("Fuel Pump: ", fuelRate);
+}
+
 #endif // STATEMACHINE_H
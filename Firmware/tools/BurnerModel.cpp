@@ -0,0 +1,102 @@
+#include "BurnerModel.h"
+
+#include <algorithm>
+#include <cmath>
+
+BurnerModel::BurnerModel(const BurnerParams& params)
+    : p(params), fanDuty(0), fuelMlPerHour(0), glowRms(0), pumpOn(false), time(0), flame(false),
+      glowTemp(params.ambientCelsius), flameTemp(params.ambientCelsius), waterTemp(params.ambientCelsius),
+      heat(0), load(0), pool(0), delivered(0), burned(0), vented(0), ignitionTime(-1), flameoutCount(0) {
+}
+
+void BurnerModel::setFan(double duty) {
+    fanDuty = std::min(std::max(duty, 0.0), 1.0);
+}
+
+void BurnerModel::setFuelRate(double mlPerHour) {
+    fuelMlPerHour = std::max(mlPerHour, 0.0);
+}
+
+void BurnerModel::setGlowVolts(double rmsVolts) {
+    glowRms = std::max(rmsVolts, 0.0);
+}
+
+void BurnerModel::setWaterPump(bool on) {
+    pumpOn = on;
+}
+
+double BurnerModel::glowVolts() const {
+    return std::min(glowRms, p.supplyVolts);
+}
+
+double BurnerModel::airKgPerHour() const {
+    return p.airMaxKgPerHour * std::sqrt(fanDuty);
+}
+
+// Air excess ratio for a fuel flow, infinite with no fuel
+double BurnerModel::lambdaFor(double fuelMlPerSecond) const {
+    double fuelKgPerHour = fuelMlPerSecond * 3.6 * p.fuelKgPerLitre;
+    if (fuelKgPerHour <= 0) return INFINITY;
+    return airKgPerHour() / (p.stoichAirFuel * fuelKgPerHour);
+}
+
+void BurnerModel::step(double dt) {
+    time += dt;
+
+    // Fuel lands on the pad
+    double in = fuelMlPerHour / 3600.0 * dt;
+    pool += in;
+    delivered += in;
+
+    // Glow plug, cooled by the chamber and the airflow through it
+    double chamber = flame ? flameTemp : p.ambientCelsius;
+    double volts = glowVolts();
+    double glowPower = volts * volts / p.glowOhms;
+    double loss = (glowTemp - chamber) * (p.glowLossStill + p.glowLossAir * fanDuty);
+    glowTemp += (glowPower - loss) / p.glowHeatCapacity * dt;
+
+    double burnRate = 0;                      // ml/s
+    if (!flame) {
+        // Glow heat drives fuel off the pad; without a flame it leaves unburnt
+        double drive = std::min(std::max((glowTemp - 200) / 600, 0.0), 1.0);
+        double evaporated = pool * drive * dt / p.coldEvaporationSeconds;
+        pool -= evaporated;
+        vented += evaporated;
+
+        double vapour = pool / p.litEvaporationSeconds;
+        double lambda = lambdaFor(vapour);
+        if (glowTemp >= p.ignitionCelsius && pool >= p.ignitionPoolMl &&
+            lambda >= p.richLimitLambda && lambda <= p.leanLimitLambda) {
+            flame = true;
+            if (ignitionTime < 0) ignitionTime = time;
+        }
+    } else {
+        // Evaporation from the hot pad, capped by the air available
+        double airLimit = airKgPerHour() / p.stoichAirFuel / p.fuelKgPerLitre / 3.6;
+        burnRate = std::min(pool / p.litEvaporationSeconds, airLimit);
+        pool -= burnRate * dt;
+        burned += burnRate * dt;
+
+        double lambda = lambdaFor(burnRate);
+        bool glowAssist = glowTemp >= p.ignitionCelsius;
+        if (lambda > p.leanLimitLambda || (!glowAssist && burnRate * 3600 < p.minFlameMlPerHour)) {
+            flame = false;
+            flameoutCount++;
+        }
+    }
+
+    // Heat release and flame sensor
+    heat = burnRate * 1e-3 * p.fuelKgPerLitre * p.fuelMjPerKg * 1e6;
+    double flameTarget = p.ambientCelsius;
+    if (flame) {
+        double lambda = std::max(lambdaFor(burnRate), 1.0);
+        flameTarget += p.flameRiseCelsius * std::min(burnRate * 3600 / 620, 1.0) / lambda;
+    }
+    flameTemp += (flameTarget - flameTemp) * std::min(dt / p.flameSeconds, 1.0);
+
+    // Coolant: heated through the exchanger, loaded only while circulating,
+    // and losing heat through the jacket whether or not the pump runs
+    load = pumpOn ? p.loadWattsPerKelvin * (waterTemp - p.ambientCelsius) : 0;
+    double standing = p.jacketWattsPerKelvin * (waterTemp - p.ambientCelsius);
+    waterTemp += (p.exchangerEfficiency * heat - load - standing) / p.waterHeatCapacity * dt;
+}
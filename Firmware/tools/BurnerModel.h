@@ -0,0 +1,103 @@
+#ifndef BURNER_MODEL_H
+#define BURNER_MODEL_H
+
+// Lumped model of the D5S burner and its water circuit for host-side
+// tuning. It is deliberately simple: a glow plug heating towards ignition,
+// fuel pooling on the evaporator pad, an air-limited flame, and a single
+// thermal mass for the coolant. Every parameter is an estimate to be
+// replaced with bench measurements; tools using it should test against a
+// spread of BurnerParams rather than trust one set.
+struct BurnerParams {
+    double ambientCelsius = 10;
+    double supplyVolts = 12;          // Caps the glow plug RMS voltage
+
+    // Glow plug
+    double glowOhms = 0.8;
+    double glowHeatCapacity = 1.6;    // J/K
+    double glowLossStill = 0.07;      // W/K to the chamber with no airflow
+    double glowLossAir = 0.10;        // Extra W/K at full fan
+    double ignitionCelsius = 850;
+    double glowLimitCelsius = 1250;   // Plug damage above this
+
+    // Air and fuel
+    double airMaxKgPerHour = 12;      // At full fan; airflow ~ sqrt(duty)
+    double stoichAirFuel = 14.5;
+    double fuelKgPerLitre = 0.84;
+    double fuelMjPerKg = 42.6;
+    double litEvaporationSeconds = 4;   // Pad pool time constant with a flame
+    double coldEvaporationSeconds = 40; // Without one, at full glow heat
+    double ignitionPoolMl = 0.05;     // Minimum wetted pad for ignition
+    double richLimitLambda = 0.5;     // Mixture limits for ignition
+    double leanLimitLambda = 4.0;     // and for holding a flame
+    double minFlameMlPerHour = 120;   // Weakest flame that holds without glow
+
+    // Flame sensor
+    double flameSeconds = 6;          // Sensor time constant
+    double flameRiseCelsius = 650;    // Above ambient at full rate, lambda 1
+
+    // Water circuit
+    double waterHeatCapacity = 21000; // J/K, about 5 l of coolant
+    double exchangerEfficiency = 0.85;
+    double loadWattsPerKelvin = 50;   // Heat drawn with the pump running
+    double jacketWattsPerKelvin = 5;  // Heater body and hoses to ambient, always
+};
+
+class BurnerModel {
+public:
+    explicit BurnerModel(const BurnerParams& params);
+
+    // Inputs, held until changed
+    void setFan(double duty);                 // 0..1
+    void setFuelRate(double mlPerHour);
+    void setGlowVolts(double rmsVolts);
+    void setWaterPump(bool on);
+
+    // Advance the model by dt seconds (keep dt small, ~0.1 s)
+    void step(double dt);
+
+    // State
+    bool lit() const { return flame; }
+    double seconds() const { return time; }
+    double glowCelsius() const { return glowTemp; }
+    double flameCelsius() const { return flameTemp; }
+    double waterCelsius() const { return waterTemp; }
+    double heatWatts() const { return heat; }
+    double loadWatts() const { return load; }     // Drawn from the coolant
+    double poolMl() const { return pool; }
+    double fan() const { return fanDuty; }
+    double fuelRate() const { return fuelMlPerHour; }
+    double glowVolts() const;
+
+    // Totals since construction
+    double fuelDeliveredMl() const { return delivered; }
+    double fuelBurnedMl() const { return burned; }
+    double fuelVentedMl() const { return vented; }   // Evaporated unburnt
+    double ignitionSeconds() const { return ignitionTime; }  // -1 until lit
+    int flameouts() const { return flameoutCount; }
+
+private:
+    BurnerParams p;
+    double fanDuty;
+    double fuelMlPerHour;
+    double glowRms;
+    bool pumpOn;
+
+    double time;
+    bool flame;
+    double glowTemp;
+    double flameTemp;
+    double waterTemp;
+    double heat;
+    double load;
+    double pool;
+    double delivered;
+    double burned;
+    double vented;
+    double ignitionTime;
+    int flameoutCount;
+
+    double airKgPerHour() const;
+    double lambdaFor(double fuelMlPerSecond) const;
+};
+
+#endif // BURNER_MODEL_H
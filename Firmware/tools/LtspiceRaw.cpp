@@ -0,0 +1,183 @@
+#include "LtspiceRaw.h"
+
+#include <cctype>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+std::string lower(std::string s) {
+    for (char& c : s) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    return s;
+}
+
+std::string trim(const std::string& s) {
+    size_t b = s.find_first_not_of(" \t\r");
+    size_t e = s.find_last_not_of(" \t\r");
+    return b == std::string::npos ? std::string() : s.substr(b, e - b + 1);
+}
+
+// Splits "Key: value" header lines
+bool splitField(const std::string& line, std::string& key, std::string& value) {
+    size_t colon = line.find(':');
+    if (colon == std::string::npos) return false;
+    key = lower(trim(line.substr(0, colon)));
+    value = trim(line.substr(colon + 1));
+    return true;
+}
+
+// Raw files are always little-endian, as is every host we build on
+template <typename T>
+bool readLittle(std::ifstream& in, T& value) {
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(T)));
+}
+
+} // namespace
+
+LtspiceRaw::LtspiceRaw(const std::string& path)
+    : in(path, std::ios::binary), utf16(false), binary(true), complexData(false),
+      allDouble(false), stepped(false), points(0), pointsRead(0) {
+    if (!in) throw std::runtime_error("cannot open " + path);
+
+    // LTspice writes UTF-16LE without a BOM; "Title:" starts with 'T', 0
+    char probe[2] = {0, 0};
+    in.read(probe, 2);
+    if (!in) throw std::runtime_error(path + ": file too short");
+    if (static_cast<unsigned char>(probe[0]) == 0xFF && static_cast<unsigned char>(probe[1]) == 0xFE) {
+        utf16 = true;                 // BOM, skip it
+    } else {
+        utf16 = probe[1] == 0;
+        in.seekg(0);
+    }
+
+    parseHeader();
+}
+
+int LtspiceRaw::findVariable(const std::string& name) const {
+    std::string wanted = lower(name);
+    for (size_t i = 0; i < vars.size(); i++) {
+        if (lower(vars[i].name) == wanted) return static_cast<int>(i);
+    }
+    return -1;
+}
+
+// Reads one character of header or ASCII data, narrowing UTF-16 code units
+int LtspiceRaw::readChar() {
+    if (!utf16) return in.get();
+    uint16_t unit;
+    if (!readLittle(in, unit)) return EOF;
+    return unit < 0x80 ? static_cast<int>(unit) : '?';
+}
+
+bool LtspiceRaw::readLine(std::string& line) {
+    line.clear();
+    int c;
+    while ((c = readChar()) != EOF) {
+        if (c == '\n') return true;
+        line.push_back(static_cast<char>(c));
+    }
+    return !line.empty();
+}
+
+bool LtspiceRaw::readToken(std::string& token) {
+    token.clear();
+    int c;
+    while ((c = readChar()) != EOF && std::isspace(c)) {
+    }
+    while (c != EOF && !std::isspace(c)) {
+        token.push_back(static_cast<char>(c));
+        c = readChar();
+    }
+    return !token.empty();
+}
+
+void LtspiceRaw::parseHeader() {
+    std::string line, key, value;
+    size_t varCount = 0;
+
+    while (readLine(line)) {
+        if (!splitField(line, key, value)) continue;
+
+        if (key == "title") {
+            titleText = value;
+        } else if (key == "plotname") {
+            plotText = value;
+        } else if (key == "flags") {
+            std::string flags = lower(value);
+            complexData = flags.find("complex") != std::string::npos;
+            allDouble = flags.find("double") != std::string::npos;
+            stepped = flags.find("stepped") != std::string::npos;
+        } else if (key == "no. variables") {
+            varCount = std::strtoul(value.c_str(), nullptr, 10);
+        } else if (key == "no. points") {
+            points = std::strtoul(value.c_str(), nullptr, 10);
+        } else if (key == "variables") {
+            for (size_t i = 0; i < varCount; i++) {
+                std::string index, name, type;
+                if (!readToken(index) || !readToken(name) || !readToken(type)) {
+                    throw std::runtime_error("truncated variable list");
+                }
+                vars.push_back({name, type});
+            }
+        } else if (key == "binary") {
+            binary = true;
+            break;
+        } else if (key == "values") {
+            binary = false;
+            break;
+        }
+    }
+
+    if (vars.empty() || vars.size() != varCount) {
+        throw std::runtime_error("missing or malformed variable list");
+    }
+}
+
+bool LtspiceRaw::next(std::vector<double>& values) {
+    if (pointsRead >= points) return false;
+    values.resize(vars.size());
+    bool ok = binary ? nextBinary(values) : nextAscii(values);
+    if (ok) pointsRead++;
+    return ok;
+}
+
+// Binary layout per point: complex runs store every variable as a pair of
+// doubles; real runs store the first variable (time, frequency or step
+// parameter) as a double and the rest as floats unless "double" is flagged.
+bool LtspiceRaw::nextBinary(std::vector<double>& values) {
+    for (size_t i = 0; i < vars.size(); i++) {
+        if (complexData) {
+            double re, im;
+            if (!readLittle(in, re) || !readLittle(in, im)) return false;
+            values[i] = re;
+        } else if (i == 0 || allDouble) {
+            double v;
+            if (!readLittle(in, v)) return false;
+            values[i] = v;
+        } else {
+            float v;
+            if (!readLittle(in, v)) return false;
+            values[i] = v;
+        }
+    }
+
+    // Compressed transient points are flagged with a negative time
+    if (lower(vars[0].name) == "time") values[0] = std::fabs(values[0]);
+    return true;
+}
+
+// ASCII layout per point: "<index>\t<value>" then one value per line,
+// complex values written as "re,im"
+bool LtspiceRaw::nextAscii(std::vector<double>& values) {
+    std::string token;
+    if (!readToken(token)) return false;  // Point index
+
+    for (size_t i = 0; i < vars.size(); i++) {
+        if (!readToken(token)) return false;
+        values[i] = std::strtod(token.c_str(), nullptr);
+    }
+    return true;
+}
@@ -0,0 +1,59 @@
+#ifndef LTSPICE_RAW_H
+#define LTSPICE_RAW_H
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Streaming reader for LTspice .raw files.
+//
+// The header is parsed up front (UTF-16LE as written by LTspice, or plain
+// ASCII as written by ngspice and "-ascii" runs); data points are then
+// decoded one at a time on each next() call, so large transient or stepped
+// runs are never held in memory.
+class LtspiceRaw {
+public:
+    struct Variable {
+        std::string name;   // e.g. "V(n002)", "tsense"
+        std::string type;   // e.g. "voltage", "param"
+    };
+
+    // Opens the file and parses the header. Throws std::runtime_error.
+    explicit LtspiceRaw(const std::string& path);
+
+    // Header fields
+    const std::string& title() const { return titleText; }
+    const std::string& plotName() const { return plotText; }
+    const std::vector<Variable>& variables() const { return vars; }
+    size_t pointCount() const { return points; }
+    bool isStepped() const { return stepped; }
+
+    // Index of a variable by name (case-insensitive), or -1
+    int findVariable(const std::string& name) const;
+
+    // Reads the next point into values (one entry per variable; the real
+    // part only for complex data). Returns false once all points are read.
+    bool next(std::vector<double>& values);
+
+private:
+    std::ifstream in;
+    bool utf16;                       // Header and ASCII data are UTF-16LE
+    bool binary;                      // "Binary:" rather than "Values:" section
+    bool complexData;                 // Flags: complex
+    bool allDouble;                   // Flags: double (every value is 8 bytes)
+    bool stepped;                     // Flags: stepped
+    std::string titleText;
+    std::string plotText;
+    std::vector<Variable> vars;
+    size_t points;
+    size_t pointsRead;
+
+    bool readLine(std::string& line);
+    bool readToken(std::string& token);
+    int readChar();
+    void parseHeader();
+    bool nextBinary(std::vector<double>& values);
+    bool nextAscii(std::vector<double>& values);
+};
+
+#endif // LTSPICE_RAW_H
@@ -0,0 +1,175 @@
+#include "SensorNetwork.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+
+const double KELVIN = 273.15;
+
+std::string lower(std::string s) {
+    for (char& c : s) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    return s;
+}
+
+} // namespace
+
+double parseSpiceValue(const std::string& text) {
+    std::string s = lower(text);
+    size_t pos = 0;
+    while (pos < s.size() && (std::isdigit(static_cast<unsigned char>(s[pos])) || s[pos] == '.')) pos++;
+    if (pos == 0) throw std::runtime_error("not a component value: " + text);
+
+    std::string mantissa = s.substr(0, pos);
+    std::string rest = s.substr(pos);
+
+    double scale = 1.0;
+    size_t suffixLength = 0;
+    if (rest.compare(0, 3, "meg") == 0) { scale = 1e6; suffixLength = 3; }
+    else if (!rest.empty()) {
+        switch (rest[0]) {
+            case 't': scale = 1e12; break;
+            case 'g': scale = 1e9; break;
+            case 'k': scale = 1e3; break;
+            case 'm': scale = 1e-3; break;
+            case 'u': scale = 1e-6; break;
+            case 'n': scale = 1e-9; break;
+            case 'p': scale = 1e-12; break;
+            case 'f': scale = 1e-15; break;
+            default: scale = 0; break;
+        }
+        if (scale != 0) suffixLength = 1;
+        else scale = 1.0;
+    }
+
+    // "1k8" style: digits after the multiplier replace the decimal point
+    std::string fraction;
+    for (size_t i = suffixLength; i < rest.size() && std::isdigit(static_cast<unsigned char>(rest[i])); i++) {
+        fraction.push_back(rest[i]);
+    }
+    if (!fraction.empty() && mantissa.find('.') == std::string::npos) mantissa += "." + fraction;
+
+    return std::strtod(mantissa.c_str(), nullptr) * scale;
+}
+
+SensorNetwork SensorNetwork::fromSchematic(const std::string& ascPath) {
+    std::ifstream in(ascPath);
+    if (!in) throw std::runtime_error("cannot open " + ascPath);
+
+    // SYMATTR lines belong to the most recent SYMBOL
+    std::map<std::string, std::string> values;
+    std::string line, instName, value;
+    auto flush = [&]() {
+        if (!instName.empty()) values[lower(instName)] = value;
+        instName.clear();
+        value.clear();
+    };
+    while (std::getline(in, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        std::istringstream fields(line);
+        std::string keyword, attribute, text;
+        fields >> keyword;
+        if (keyword == "SYMBOL") {
+            flush();
+        } else if (keyword == "SYMATTR") {
+            fields >> attribute >> text;
+            if (attribute == "InstName") instName = text;
+            else if (attribute == "Value") value = text;
+        }
+    }
+    flush();
+
+    auto component = [&](const char* name) {
+        auto it = values.find(name);
+        if (it == values.end() || it->second.empty()) {
+            throw std::runtime_error(ascPath + ": no value for " + std::string(name));
+        }
+        return parseSpiceValue(it->second);
+    };
+
+    SensorNetwork net;
+    net.supply = component("v1");
+    net.pullUp = component("r2");
+    net.input = component("r3");
+    net.feedback = component("r4");
+    net.refHigh = component("r5");
+    net.refLow = component("r6");
+    net.offset = 0;
+    return net;
+}
+
+double SensorNetwork::outputVolts(double sensorOhms) const {
+    // In- sits at Vref through feedback, so R3 loads the sensor divider
+    double vref = supply * refLow / (refHigh + refLow) + offset;
+    double node = (supply / pullUp + vref / input) / (1.0 / sensorOhms + 1.0 / pullUp + 1.0 / input);
+    double out = vref + (vref - node) * feedback / input;
+    return std::min(std::max(out, 0.0), supply);
+}
+
+double SensorNetwork::adcCounts(double sensorOhms) const {
+    return std::min(outputVolts(sensorOhms) / supply * 1024.0, 1023.0);
+}
+
+SensorCurve::SensorCurve(const std::string& spec) : kind(NTC), r25(0), beta(0) {
+    std::string s = lower(spec);
+    if (s == "pt1000") {
+        kind = PT1000;
+    } else if (s.compare(0, 4, "ntc:") == 0) {
+        kind = NTC;
+        size_t colon = s.find(':', 4);
+        if (colon == std::string::npos) throw std::runtime_error("expected ntc:<R25>:<beta>");
+        r25 = parseSpiceValue(s.substr(4, colon - 4));
+        beta = std::strtod(s.c_str() + colon + 1, nullptr);
+        if (r25 <= 0 || beta <= 0) throw std::runtime_error("bad NTC parameters: " + spec);
+    } else if (s.compare(0, 4, "csv:") == 0) {
+        kind = TABLE;
+        std::string path = spec.substr(4);
+        std::ifstream in(path);
+        if (!in) throw std::runtime_error("cannot open " + path);
+
+        std::vector<std::pair<double, double>> rows;
+        std::string line;
+        while (std::getline(in, line)) {
+            char* end;
+            double celsius = std::strtod(line.c_str(), &end);
+            if (end == line.c_str() || *end != ',') continue;  // Header or blank line
+            double ohms = std::strtod(end + 1, nullptr);
+            if (ohms > 0) rows.push_back({celsius, ohms});
+        }
+        if (rows.size() < 2) throw std::runtime_error(path + ": need at least two celsius,ohms rows");
+        std::sort(rows.begin(), rows.end());
+        for (const auto& row : rows) {
+            tableCelsius.push_back(row.first);
+            tableLogOhms.push_back(std::log(row.second));
+        }
+    } else {
+        throw std::runtime_error("unknown sensor spec: " + spec);
+    }
+}
+
+double SensorCurve::ohmsAt(double celsius) const {
+    switch (kind) {
+        case NTC:
+            return r25 * std::exp(beta * (1.0 / (celsius + KELVIN) - 1.0 / (25.0 + KELVIN)));
+        case PT1000: {
+            // Callendar-Van Dusen, IEC 60751 coefficients
+            const double a = 3.9083e-3, b = -5.775e-7, c = -4.183e-12;
+            double r = 1000.0 * (1 + a * celsius + b * celsius * celsius);
+            if (celsius < 0) r += 1000.0 * c * (celsius - 100) * celsius * celsius * celsius;
+            return r;
+        }
+        case TABLE:
+        default: {
+            size_t i = std::upper_bound(tableCelsius.begin(), tableCelsius.end(), celsius) - tableCelsius.begin();
+            i = std::min(std::max<size_t>(i, 1), tableCelsius.size() - 1);
+            double t = (celsius - tableCelsius[i - 1]) / (tableCelsius[i] - tableCelsius[i - 1]);
+            return std::exp(tableLogOhms[i - 1] + t * (tableLogOhms[i] - tableLogOhms[i - 1]));
+        }
+    }
+}
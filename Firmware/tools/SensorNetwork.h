@@ -0,0 +1,59 @@
+#ifndef SENSOR_NETWORK_H
+#define SENSOR_NETWORK_H
+
+#include <string>
+#include <vector>
+
+// Analytic model of the sensor front-end drawn in Simulations/*.asc. All
+// three sensors use the same inverting stage, only the values differ:
+//
+//   V1 --R2--+--R1 (sensor)-- GND         V1 --R5--+--R6-- GND
+//            |                                     |
+//            +--R3--+-- In-                        +-- In+ (Vref)
+//                   |        Out --+--> ADC
+//                   +----R4--------+
+//
+// The model is checked against LTspice's own operating points by the
+// calibrate tool, then used for dense curves and tolerance sweeps.
+struct SensorNetwork {
+    double supply;      // V1, also the ADC reference (AVCC)
+    double pullUp;      // R2
+    double input;       // R3
+    double feedback;    // R4
+    double refHigh;     // R5
+    double refLow;      // R6
+    double offset;      // Op-amp input offset voltage
+
+    // Reads V1 and R2..R6 from an LTspice schematic. Throws std::runtime_error.
+    static SensorNetwork fromSchematic(const std::string& ascPath);
+
+    // Op-amp output for a given sensor resistance, clamped to the rails
+    double outputVolts(double sensorOhms) const;
+
+    // 10-bit analogRead() result for that output, unrounded
+    double adcCounts(double sensorOhms) const;
+};
+
+// Resistance-versus-temperature characteristic of the sensing element.
+// Specs: "ntc:<R25>:<beta>", "pt1000", or "csv:<file>" with one
+// "celsius,ohms" pair per line (interpolated in log-resistance).
+class SensorCurve {
+public:
+    // Throws std::runtime_error on a bad spec
+    explicit SensorCurve(const std::string& spec);
+
+    double ohmsAt(double celsius) const;
+
+private:
+    enum Kind { NTC, PT1000, TABLE };
+    Kind kind;
+    double r25;
+    double beta;
+    std::vector<double> tableCelsius;
+    std::vector<double> tableLogOhms;
+};
+
+// Parses an LTspice component value such as "1k8", "2K2", "910", "4.7meg"
+double parseSpiceValue(const std::string& text);
+
+#endif // SENSOR_NETWORK_H
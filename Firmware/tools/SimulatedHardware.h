@@ -0,0 +1,52 @@
+#ifndef SIMULATED_HARDWARE_H
+#define SIMULATED_HARDWARE_H
+
+#include <stdint.h>
+
+#include "BurnerModel.h"
+
+// Hardware backend for StateMachine<SimulatedHardware>: the same calls as
+// HardwareInterface<Board>, wired to a BurnerModel and a simulated clock.
+// The caller advances time with run() between ticks, as delay() does on
+// the AVR.
+class SimulatedHardware {
+public:
+    explicit SimulatedHardware(BurnerModel& model) : burner(model), clock(0) {}
+
+    // The model takes any rate the firmware's uint16_t can carry
+    static constexpr uint16_t maxFuelRate = 0xFFFF;
+
+    // Output controls
+    void setFanDuty(uint16_t duty) { burner.setFan(duty / 65535.0); }
+    void setFuelRate(uint16_t mlPerHour) { burner.setFuelRate(mlPerHour); }
+    void setWaterPumpState(bool state) { burner.setWaterPump(state); }
+    void setBlowerState(bool) {}
+    void setGlowVoltage(uint16_t millivolts) { burner.setGlowVolts(millivolts / 1000.0); }
+    void applyOutputs() {}
+
+    // Derived inputs
+    int getWaterTemp() { return static_cast<int>(burner.waterCelsius() + 0.5); }
+    int getFlameTemp() { return static_cast<int>(burner.flameCelsius() + 0.5); }
+
+    // Timing and logging for the state machine
+    unsigned long millis() { return clock; }
+    void log(const char*) {}
+    void log(const char*, int) {}
+
+    // Advance the clock and the model, in model steps of at most 100 ms
+    void run(unsigned long ms) {
+        for (unsigned long done = 0; done < ms; done += 100) {
+            unsigned long slice = ms - done < 100 ? ms - done : 100;
+            burner.step(slice / 1000.0);
+        }
+        clock += ms;
+    }
+
+    BurnerModel& model() { return burner; }
+
+private:
+    BurnerModel& burner;
+    unsigned long clock;
+};
+
+#endif // SIMULATED_HARDWARE_H
@@ -0,0 +1,418 @@
+// Host tool: builds firmware sensor calibration tables from the LTspice
+// models in Simulations/.
+//
+//   calibrate --asc ../../Simulations/OtempSensor.asc
+//             --raw ../../Simulations/OtempSensor.raw --node "V(n003)"
+//             --sensor ntc:10k:3977 --range 0:120 --name overTempMapping
+//
+// 1. Streams the stepped .raw (if given) and checks the analytic network
+//    model against LTspice's operating points.
+// 2. Picks the breakpoints that minimise the worst-case error of the
+//    firmware's integer interpolate() for the requested number of points.
+// 3. Runs a multi-threaded Monte Carlo sweep over resistor, sensor, supply
+//    and op-amp offset tolerances and reports the error bounds per point.
+// 4. Prints a VoltageTempMapping table ready to paste into HardwareConfig.h.
+
+#include "LtspiceRaw.h"
+#include "SensorNetwork.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Mirrors VoltageTempMapping in HardwareConfig.h
+struct Mapping {
+    int voltage;
+    int temperature;
+};
+
+struct Options {
+    std::string asc;
+    std::string raw;
+    std::string node = "V(n003)";
+    std::string sensor;
+    std::string name = "sensorMapping";
+    std::string out;
+    double minCelsius = 0;
+    double maxCelsius = 100;
+    int points = 8;
+    double resistorTolerance = 1.0;   // Percent
+    double sensorTolerance = 0.0;     // Percent
+    double supplyTolerance = 0.0;     // Percent
+    double offsetVolts = 2e-3;        // Op-amp input offset, +/- volts
+    long samples = 100000;
+    unsigned threads = 0;
+    unsigned long seed = 1;
+};
+
+// Interpolation exactly as HardwareInterface::interpolate does it on the
+// AVR, including integer truncation.
+int firmwareInterpolate(int rawValue, const std::vector<Mapping>& mapping) {
+    size_t size = mapping.size();
+    for (size_t i = 0; i < size - 1; i++) {
+        int x1 = mapping[i].voltage;
+        int y1 = mapping[i].temperature;
+        int x2 = mapping[i + 1].voltage;
+        int y2 = mapping[i + 1].temperature;
+        if (rawValue >= x1 && rawValue <= x2) {
+            return y1 + (y2 - y1) * (rawValue - x1) / (x2 - x1);
+        }
+    }
+    size_t a = rawValue < mapping[0].voltage ? 0 : size - 2;
+    int x1 = mapping[a].voltage;
+    int y1 = mapping[a].temperature;
+    int x2 = mapping[a + 1].voltage;
+    int y2 = mapping[a + 1].temperature;
+    return y1 + (y2 - y1) * (rawValue - x1) / (x2 - x1);
+}
+
+// The AVR computes (y2 - y1) * (raw - x1) in a 16-bit int. Inside a segment
+// |raw - x1| is at most its span; the end segments are also extrapolated over
+// the rest of the 0..1023 readings. a is the lower-voltage point.
+bool fitsAvrInt(const Mapping& a, const Mapping& b, bool lowEnd, bool highEnd) {
+    int reach = b.voltage - a.voltage;
+    if (lowEnd) reach = std::max(reach, a.voltage);
+    if (highEnd) reach = std::max(reach, 1023 - a.voltage);
+    return std::abs(b.temperature - a.temperature) * reach <= 32767;
+}
+
+// Nominal curve sampled every tenth of a degree
+struct Curve {
+    std::vector<double> celsius;
+    std::vector<double> counts;
+    bool rising;                      // Counts increase with temperature
+};
+
+Curve nominalCurve(const SensorNetwork& net, const SensorCurve& sensor, const Options& opt) {
+    Curve curve;
+    long steps = std::lround((opt.maxCelsius - opt.minCelsius) * 10);
+    for (long i = 0; i <= steps; i++) {
+        double t = opt.minCelsius + i / 10.0;
+        curve.celsius.push_back(t);
+        curve.counts.push_back(net.adcCounts(sensor.ohmsAt(t)));
+    }
+
+    curve.rising = curve.counts.back() > curve.counts.front();
+    for (size_t i = 1; i < curve.counts.size(); i++) {
+        double step = curve.counts[i] - curve.counts[i - 1];
+        if (curve.rising ? step <= 0 : step >= 0) {
+            throw std::runtime_error("ADC curve is not strictly monotonic over the range (output clipping?)");
+        }
+    }
+    return curve;
+}
+
+// Candidate breakpoint at curve sample i: integer temperature, rounded counts
+Mapping breakpointAt(const Curve& curve, size_t i) {
+    return {static_cast<int>(std::lround(curve.counts[i])), static_cast<int>(std::lround(curve.celsius[i]))};
+}
+
+// Worst interpolation error of the segment a..b over the samples between
+// them; infinite if the firmware cannot use the segment
+double segmentError(const Curve& curve, size_t a, size_t b) {
+    std::vector<Mapping> segment = {breakpointAt(curve, a), breakpointAt(curve, b)};
+    if (segment[0].voltage > segment[1].voltage) std::swap(segment[0], segment[1]);
+    size_t last = curve.celsius.size() - 1;
+    bool lowEnd = curve.rising ? a == 0 : b == last;
+    bool highEnd = curve.rising ? b == last : a == 0;
+    if (segment[0].voltage == segment[1].voltage || !fitsAvrInt(segment[0], segment[1], lowEnd, highEnd)) {
+        return std::numeric_limits<double>::infinity();
+    }
+
+    double worst = 0;
+    for (size_t i = a; i <= b; i++) {
+        int reading = static_cast<int>(std::lround(curve.counts[i]));
+        worst = std::max(worst, std::fabs(firmwareInterpolate(reading, segment) - curve.celsius[i]));
+    }
+    return worst;
+}
+
+// Curve sample indices of a table's breakpoints
+struct Breakpoints {
+    std::vector<size_t> picked;
+    bool withinTolerance = true;      // False if some segment had to exceed it
+};
+
+// Greedy longest segments within a tolerance; breakpoints on whole degrees.
+// A breakpoint sharing the last point's ADC count could never be joined to
+// it, so those are skipped.
+Breakpoints greedyBreakpoints(const Curve& curve, double tolerance) {
+    Breakpoints result;
+    std::vector<size_t>& picked = result.picked;
+    picked.push_back(0);
+    size_t last = curve.celsius.size() - 1;
+    long lastCount = std::lround(curve.counts[last]);
+    while (picked.back() != last) {
+        size_t from = picked.back();
+        size_t best = 0;
+        size_t usable = 0;
+        for (size_t to = from + 10; to <= last; to += 10) {
+            if (to != last && std::lround(curve.counts[to]) == lastCount) continue;
+            double error = segmentError(curve, from, to);
+            if (error <= tolerance) best = to;
+            if (std::isfinite(error)) usable = to;
+        }
+        // Tolerance unreachable from here: take the longest segment the
+        // firmware can still use and keep going
+        if (best == 0) {
+            best = usable;
+            result.withinTolerance = false;
+        }
+        if (best == 0) throw std::runtime_error("too little ADC resolution for a table over this range");
+        picked.push_back(best);
+    }
+    return result;
+}
+
+// Bisects the tolerance for the smallest one the greedy fit meets with the
+// requested number of points
+std::vector<Mapping> fitTable(const Curve& curve, int points) {
+    double low = 0, high = curve.celsius.back() - curve.celsius.front();
+    Breakpoints best = greedyBreakpoints(curve, high);
+    for (int iteration = 0; iteration < 30; iteration++) {
+        double mid = (low + high) / 2;
+        Breakpoints candidate = greedyBreakpoints(curve, mid);
+        if (candidate.withinTolerance && static_cast<int>(candidate.picked.size()) <= points) {
+            high = mid;
+            best = candidate;
+        } else {
+            low = mid;
+        }
+    }
+
+    if (static_cast<int>(best.picked.size()) > points) {
+        std::fprintf(stderr, "note: %zu points are the fewest the firmware's 16-bit interpolation can use\n",
+                     best.picked.size());
+    }
+
+    std::vector<Mapping> table;
+    for (size_t i : best.picked) table.push_back(breakpointAt(curve, i));
+    std::sort(table.begin(), table.end(), [](const Mapping& a, const Mapping& b) { return a.voltage < b.voltage; });
+    for (size_t k = 1; k < table.size(); k++) {
+        if (table[k].voltage == table[k - 1].voltage) {
+            throw std::runtime_error("too little ADC resolution for a table over this range");
+        }
+        if (!fitsAvrInt(table[k - 1], table[k], k == 1, k + 1 == table.size())) {
+            throw std::runtime_error("table overflows the firmware's 16-bit interpolation");
+        }
+    }
+    return table;
+}
+
+// Error range of the firmware reading at one temperature
+struct Bounds {
+    double low = std::numeric_limits<double>::infinity();
+    double high = -std::numeric_limits<double>::infinity();
+
+    void add(double error) {
+        low = std::min(low, error);
+        high = std::max(high, error);
+    }
+    void merge(const Bounds& other) {
+        low = std::min(low, other.low);
+        high = std::max(high, other.high);
+    }
+};
+
+// Checks the nominal table against the whole curve
+Bounds nominalError(const Curve& curve, const std::vector<Mapping>& table) {
+    Bounds bounds;
+    for (size_t i = 0; i < curve.celsius.size(); i++) {
+        int reading = static_cast<int>(std::lround(curve.counts[i]));
+        bounds.add(firmwareInterpolate(reading, table) - curve.celsius[i]);
+    }
+    return bounds;
+}
+
+struct SweepResult {
+    std::vector<Bounds> perPoint;     // One per table entry
+    Bounds overall;                   // Every whole degree in the range
+};
+
+// Monte Carlo over component tolerances, split across worker threads
+SweepResult toleranceSweep(const SensorNetwork& nominal, const SensorCurve& sensor,
+                           const std::vector<Mapping>& table, const Options& opt) {
+    unsigned threads = opt.threads ? opt.threads : std::max(1u, std::thread::hardware_concurrency());
+    std::vector<SweepResult> partial(threads);
+    std::vector<std::thread> workers;
+
+    for (unsigned w = 0; w < threads; w++) {
+        workers.emplace_back([&, w]() {
+            SweepResult& result = partial[w];
+            result.perPoint.resize(table.size());
+
+            std::mt19937_64 rng(opt.seed + w);
+            std::uniform_real_distribution<double> unit(-1.0, 1.0);
+            auto vary = [&](double value, double percent) { return value * (1 + unit(rng) * percent / 100); };
+
+            for (long s = w; s < opt.samples; s += threads) {
+                SensorNetwork net = nominal;
+                net.supply = vary(nominal.supply, opt.supplyTolerance);
+                net.pullUp = vary(nominal.pullUp, opt.resistorTolerance);
+                net.input = vary(nominal.input, opt.resistorTolerance);
+                net.feedback = vary(nominal.feedback, opt.resistorTolerance);
+                net.refHigh = vary(nominal.refHigh, opt.resistorTolerance);
+                net.refLow = vary(nominal.refLow, opt.resistorTolerance);
+                net.offset = unit(rng) * opt.offsetVolts;
+                double sensorScale = vary(1.0, opt.sensorTolerance);
+
+                auto error = [&](double celsius) {
+                    int reading = static_cast<int>(std::lround(net.adcCounts(sensor.ohmsAt(celsius) * sensorScale)));
+                    return firmwareInterpolate(reading, table) - celsius;
+                };
+
+                for (size_t k = 0; k < table.size(); k++) result.perPoint[k].add(error(table[k].temperature));
+                for (double t = std::ceil(opt.minCelsius); t <= opt.maxCelsius; t += 1) result.overall.add(error(t));
+            }
+        });
+    }
+    for (std::thread& worker : workers) worker.join();
+
+    SweepResult merged;
+    merged.perPoint.resize(table.size());
+    for (const SweepResult& result : partial) {
+        if (result.perPoint.empty()) continue;
+        for (size_t k = 0; k < table.size(); k++) merged.perPoint[k].merge(result.perPoint[k]);
+        merged.overall.merge(result.overall);
+    }
+    return merged;
+}
+
+// Streams the stepped .raw and compares each operating point with the model
+void checkAgainstSpice(const SensorNetwork& net, const Options& opt) {
+    LtspiceRaw raw(opt.raw);
+    int node = raw.findVariable(opt.node);
+    if (node < 0) throw std::runtime_error(opt.raw + ": no variable " + opt.node);
+    if (raw.variables()[0].type != "param") {
+        throw std::runtime_error(opt.raw + ": expected a .step param sweep of the sensor resistance");
+    }
+
+    std::fprintf(stderr, "%s (%zu points)\n  %10s %10s %10s\n", raw.title().c_str(), raw.pointCount(),
+                 raw.variables()[0].name.c_str(), "spice V", "model V");
+    double worst = 0;
+    std::vector<double> values;
+    while (raw.next(values)) {
+        double model = net.outputVolts(values[0]);
+        worst = std::max(worst, std::fabs(model - values[node]));
+        std::fprintf(stderr, "  %10.0f %10.4f %10.4f\n", values[0], values[node], model);
+    }
+    std::fprintf(stderr, "  worst model deviation %.2f mV\n", worst * 1000);
+    if (worst > 0.01) std::fprintf(stderr, "  warning: model disagrees with LTspice, check --node and the schematic\n");
+}
+
+void writeTable(FILE* out, const std::vector<Mapping>& table, const Bounds& nominal,
+                const SweepResult& sweep, const Options& opt) {
+    std::fprintf(out, "    // Generated by tools/calibrate: %s, sensor %s, %g..%g C\n", opt.asc.c_str(),
+                 opt.sensor.c_str(), opt.minCelsius, opt.maxCelsius);
+    std::fprintf(out, "    // Nominal interpolation error %+.1f/%+.1f C; %ld samples at R %g%%, sensor %g%%, "
+                      "supply %g%%, offset %g mV\n",
+                 nominal.low, nominal.high, opt.samples, opt.resistorTolerance, opt.sensorTolerance,
+                 opt.supplyTolerance, opt.offsetVolts * 1000);
+    std::fprintf(out, "    // Worst case over the range %+.1f/%+.1f C\n", sweep.overall.low, sweep.overall.high);
+    std::fprintf(out, "    static constexpr VoltageTempMapping %s[] = {\n", opt.name.c_str());
+    for (size_t k = 0; k < table.size(); k++) {
+        char entry[32];
+        std::snprintf(entry, sizeof(entry), "{%d, %d}%s", table[k].voltage, table[k].temperature,
+                      k + 1 < table.size() ? "," : "");
+        std::fprintf(out, "        %-12s // %+.1f/%+.1f C\n", entry, sweep.perPoint[k].low, sweep.perPoint[k].high);
+    }
+    std::fprintf(out, "    };\n");
+}
+
+void usage() {
+    std::fprintf(stderr,
+                 "usage: calibrate --asc <schematic> --sensor <spec> [options]\n"
+                 "  --raw <file>         stepped LTspice .raw to check the model against\n"
+                 "  --node <name>        op-amp output variable in the .raw (default V(n003))\n"
+                 "  --sensor <spec>      ntc:<R25>:<beta> | pt1000 | csv:<celsius,ohms file>\n"
+                 "  --range <min>:<max>  whole-degree temperature range in C (default 0:100)\n"
+                 "  --points <n>         table size (default 8)\n"
+                 "  --name <identifier>  table name (default sensorMapping)\n"
+                 "  --res-tol <%%>        resistor tolerance (default 1)\n"
+                 "  --sensor-tol <%%>     sensor resistance tolerance (default 0)\n"
+                 "  --supply-tol <%%>     V1 tolerance (default 0)\n"
+                 "  --offset <mV>        op-amp input offset (default 2)\n"
+                 "  --samples <n>        Monte Carlo samples (default 100000)\n"
+                 "  --threads <n>        worker threads (default: all cores)\n"
+                 "  --seed <n>           random seed (default 1)\n"
+                 "  --out <file>         write the table here instead of stdout\n");
+}
+
+Options parseArgs(int argc, char** argv) {
+    Options opt;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) throw std::runtime_error("missing value for " + arg);
+        const char* value = argv[++i];
+
+        if (arg == "--asc") opt.asc = value;
+        else if (arg == "--raw") opt.raw = value;
+        else if (arg == "--node") opt.node = value;
+        else if (arg == "--sensor") opt.sensor = value;
+        else if (arg == "--name") opt.name = value;
+        else if (arg == "--out") opt.out = value;
+        else if (arg == "--range") {
+            char* end;
+            opt.minCelsius = std::strtod(value, &end);
+            if (*end != ':') throw std::runtime_error("expected --range <min>:<max>");
+            opt.maxCelsius = std::strtod(end + 1, nullptr);
+        }
+        else if (arg == "--points") opt.points = std::atoi(value);
+        else if (arg == "--res-tol") opt.resistorTolerance = std::atof(value);
+        else if (arg == "--sensor-tol") opt.sensorTolerance = std::atof(value);
+        else if (arg == "--supply-tol") opt.supplyTolerance = std::atof(value);
+        else if (arg == "--offset") opt.offsetVolts = std::atof(value) / 1000;
+        else if (arg == "--samples") opt.samples = std::atol(value);
+        else if (arg == "--threads") opt.threads = static_cast<unsigned>(std::atoi(value));
+        else if (arg == "--seed") opt.seed = std::strtoul(value, nullptr, 10);
+        else throw std::runtime_error("unknown option " + arg);
+    }
+
+    if (opt.asc.empty() || opt.sensor.empty()) throw std::runtime_error("--asc and --sensor are required");
+    // Breakpoints sit on whole degrees from the low bound, so a fractional
+    // bound would leave the top of the range unreachable or bias the table
+    if (opt.minCelsius != std::floor(opt.minCelsius) || opt.maxCelsius != std::floor(opt.maxCelsius)) {
+        throw std::runtime_error("--range bounds must be whole degrees");
+    }
+    if (opt.maxCelsius - opt.minCelsius < 2) throw std::runtime_error("--range must span at least 2 C");
+    if (opt.points < 2) throw std::runtime_error("--points must be at least 2");
+    if (opt.samples < 1) throw std::runtime_error("--samples must be positive");
+    return opt;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    try {
+        Options opt = parseArgs(argc, argv);
+        SensorNetwork net = SensorNetwork::fromSchematic(opt.asc);
+        SensorCurve sensor(opt.sensor);
+
+        if (!opt.raw.empty()) checkAgainstSpice(net, opt);
+
+        Curve curve = nominalCurve(net, sensor, opt);
+        std::vector<Mapping> table = fitTable(curve, opt.points);
+        Bounds nominal = nominalError(curve, table);
+        SweepResult sweep = toleranceSweep(net, sensor, table, opt);
+
+        FILE* out = opt.out.empty() ? stdout : std::fopen(opt.out.c_str(), "w");
+        if (!out) throw std::runtime_error("cannot write " + opt.out);
+        writeTable(out, table, nominal, sweep, opt);
+        if (out != stdout) std::fclose(out);
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "calibrate: %s\n", e.what());
+        usage();
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,140 @@
+// Host tool: compares the LARGE/SMALL stages with the modulating PI mode on
+// the simulated burner, running the real StateMachine<SimulatedHardware>.
+//
+//   modulationSim [--hours 2] [--csv trace.csv]
+//
+// Each circuit load runs a full start, then both modes are scored from the
+// end of the warm-up on water temperature deviation from
+// WATER_TEMP_SETPOINT and on fuel used per kWh delivered to the circuit.
+
+#include "BurnerModel.h"
+#include "SimulatedHardware.h"
+#include "../src/StateMachine.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+const double WARM_UP_SECONDS = 1200;
+
+struct Summary {
+    double meanAbsDeviation = 0;      // Degrees C from the setpoint
+    double rmsDeviation = 0;
+    double minCelsius = 1e9;
+    double maxCelsius = -1e9;
+    double fuelMlPerHour = 0;
+    double heatKwh = 0;               // Delivered to the circuit
+    double fuelMlPerKwh = 0;
+    int modeChanges = 0;              // LARGE/SMALL switches
+    int shutdowns = 0;
+    int flameouts = 0;
+};
+
+Summary run(bool modulation, double loadWattsPerKelvin, double hours, FILE* trace) {
+    BurnerParams params;
+    params.loadWattsPerKelvin = loadWattsPerKelvin;
+    BurnerModel burner(params);
+    SimulatedHardware hw(burner);
+    StateMachine<SimulatedHardware> sm(hw);
+    sm.setModulation(modulation);
+    sm.init();
+    sm.setRunSignal(true);
+
+    Summary s;
+    long samples = 0;
+    double sumAbs = 0, sumSquares = 0, heatJoules = 0;
+    double fuelAtWarm = -1;
+    State last = sm.getCurrentState();
+    const unsigned long tickMs = 1000;    // loop() delay
+    const double end = WARM_UP_SECONDS + hours * 3600;
+
+    for (double t = 0; t < end; t += tickMs / 1000.0) {
+        sm.tick();
+        hw.run(tickMs);
+
+        State state = sm.getCurrentState();
+        if (state != last) {
+            if ((state == LARGE || state == SMALL) && (last == LARGE || last == SMALL)) s.modeChanges++;
+            if (state == SHUTDOWN) s.shutdowns++;
+            last = state;
+        }
+
+        if (trace) {
+            std::fprintf(trace, "%s,%.0f,%.0f,%d,%.2f,%.1f,%.0f,%.0f\n", modulation ? "modulating" : "stages",
+                         loadWattsPerKelvin, t, state, burner.waterCelsius(), burner.fan() * 255, burner.fuelRate(),
+                         burner.heatWatts());
+        }
+
+        if (t < WARM_UP_SECONDS) continue;
+        if (fuelAtWarm < 0) fuelAtWarm = burner.fuelDeliveredMl();
+
+        double deviation = burner.waterCelsius() - WATER_TEMP_SETPOINT;
+        sumAbs += std::fabs(deviation);
+        sumSquares += deviation * deviation;
+        samples++;
+        s.minCelsius = std::min(s.minCelsius, burner.waterCelsius());
+        s.maxCelsius = std::max(s.maxCelsius, burner.waterCelsius());
+        heatJoules += burner.loadWatts() * tickMs / 1000.0;
+    }
+
+    s.meanAbsDeviation = sumAbs / samples;
+    s.rmsDeviation = std::sqrt(sumSquares / samples);
+    s.fuelMlPerHour = (burner.fuelDeliveredMl() - fuelAtWarm) / hours;
+    s.heatKwh = heatJoules / 3.6e6;
+    s.fuelMlPerKwh = (burner.fuelDeliveredMl() - fuelAtWarm) / s.heatKwh;
+    s.flameouts = burner.flameouts();
+    return s;
+}
+
+void print(const char* label, const Summary& s) {
+    std::printf("  %-10s %6.2f %6.2f %6.1f..%-5.1f %8.0f %7.2f %8.1f %6d %5d %5d\n", label, s.meanAbsDeviation,
+                s.rmsDeviation, s.minCelsius, s.maxCelsius, s.fuelMlPerHour, s.heatKwh, s.fuelMlPerKwh,
+                s.modeChanges, s.shutdowns, s.flameouts);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    double hours = 2;
+    std::string csv;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--hours" && i + 1 < argc) hours = std::atof(argv[++i]);
+        else if (arg == "--csv" && i + 1 < argc) csv = argv[++i];
+        else {
+            std::fprintf(stderr, "usage: modulationSim [--hours <h>] [--csv <trace file>]\n");
+            return 1;
+        }
+    }
+    if (hours <= 0) {
+        std::fprintf(stderr, "modulationSim: --hours must be positive\n");
+        return 1;
+    }
+
+    FILE* trace = nullptr;
+    if (!csv.empty()) {
+        trace = std::fopen(csv.c_str(), "w");
+        if (!trace) {
+            std::fprintf(stderr, "modulationSim: cannot write %s\n", csv.c_str());
+            return 1;
+        }
+        std::fprintf(trace, "mode,load_w_per_k,seconds,state,water_c,fan,fuel_ml_h,heat_w\n");
+    }
+
+    std::printf("Setpoint %d C, %.1f h after a %.0f s warm-up\n", WATER_TEMP_SETPOINT, hours, WARM_UP_SECONDS);
+    std::printf("  %-10s %6s %6s %12s %8s %7s %8s %6s %5s %5s\n", "mode", "|dev|", "rms", "range C", "ml/h", "kWh",
+                "ml/kWh", "switch", "stops", "outs");
+    for (double load : {35.0, 50.0, 65.0}) {
+        std::printf("Circuit load %.0f W/K\n", load);
+        print("stages", run(false, load, hours, trace));
+        print("modulating", run(true, load, hours, trace));
+    }
+
+    if (trace) std::fclose(trace);
+    return 0;
+}
@@ -0,0 +1,606 @@
+// Host tool: tunes the START stage table against the simulated burner.
+//
+//   optimizeStart --stages ../src/Stages.h --out Stages.h --report start.csv
+//
+// The startStages table and its #define values are read from --stages, and
+// the tuned table is spliced back into a copy of that file. The candidate
+// table runs through the real StateMachine<SimulatedHardware> at the
+// firmware's one-second tick, in several burner scenarios; the other stage
+// tables, thresholds and search bounds are the ones compiled in from
+// ../src/Stages.h. Each stage keeps its pump, blower, glow and condition
+// settings; the search tunes the durations and the fan and fuel ramps with
+// differential evolution, scoring the worst scenario on time to LARGE, time
+// to flame and fuel used. Any candidate breaking a safety constraint in any
+// scenario is ranked below every safe one.
+//
+// Fuel genes stay within FUEL_PUMP_OFF..FUEL_PUMP_HIGH ml/h. The firmware
+// drives setFuelRate() with a 16-bit rate and StateMachine checks at compile
+// time that every board's maxFuelRate covers FUEL_PUMP_HIGH, so each table
+// the search can write is one the heater can deliver.
+
+#include "BurnerModel.h"
+#include "SimulatedHardware.h"
+#include "../src/StateMachine.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct Options {
+    std::string stagesPath = "../src/Stages.h";
+    std::string out;
+    std::string report;
+    int generations = 150;
+    int population = 60;
+    unsigned threads = 0;
+    unsigned long seed = 1;
+    double flameWeight = 0.5;         // Cost per second to first flame
+    double fuelWeight = 20;           // Cost per ml delivered before LARGE
+};
+
+// Safety limits checked every tick
+const double MAX_POOL_ML = 1.5;             // Unburnt fuel on the pad
+const double MAX_VENTED_ML = 0.5;           // Fuel evaporated without burning
+const double MIN_LIT_BEFORE_GLOW_OFF = 10;  // Seconds of flame before glow off
+const double MIN_FAN_WHILE_LIT = FAN_SPEED_VERY_SMALL / 255.0;
+const double TAIL_SECONDS = 60;             // Flame must hold this long in LARGE
+const double START_LIMIT_SECONDS = 400;
+
+// Stage limits for the search
+const double MIN_DURATION = 1;
+const double MAX_DURATION = 60;
+
+// Stage table parsed from a Stages.h; owns the strings its stages point to
+struct StageTable {
+    std::vector<std::string> messages;
+    std::vector<Stage> stages;
+    std::map<std::string, int> defines;
+};
+
+std::string readFile(const std::string& path) {
+    std::ifstream in(path);
+    if (!in) throw std::runtime_error("cannot open " + path);
+    std::stringstream buffer;
+    buffer << in.rdbuf();
+    return buffer.str();
+}
+
+// Drops // comments outside string literals
+std::string stripComments(const std::string& text) {
+    std::string out;
+    bool quoted = false;
+    for (size_t i = 0; i < text.size(); i++) {
+        if (text[i] == '"' && (i == 0 || text[i - 1] != '\\')) quoted = !quoted;
+        if (!quoted && text.compare(i, 2, "//") == 0) {
+            i = text.find('\n', i);
+            if (i == std::string::npos) break;
+        }
+        out += text[i];
+    }
+    return out;
+}
+
+std::string trim(const std::string& s) {
+    size_t begin = s.find_first_not_of(" \t\r\n");
+    if (begin == std::string::npos) return "";
+    return s.substr(begin, s.find_last_not_of(" \t\r\n") - begin + 1);
+}
+
+// Splits on commas outside braces and string literals
+std::vector<std::string> splitTopLevel(const std::string& text) {
+    std::vector<std::string> parts;
+    std::string current;
+    int depth = 0;
+    bool quoted = false;
+    for (size_t i = 0; i < text.size(); i++) {
+        char ch = text[i];
+        if (ch == '"' && (i == 0 || text[i - 1] != '\\')) quoted = !quoted;
+        if (!quoted && ch == '{') depth++;
+        if (!quoted && ch == '}') depth--;
+        if (!quoted && depth == 0 && ch == ',') {
+            parts.push_back(trim(current));
+            current.clear();
+        } else {
+            current += ch;
+        }
+    }
+    if (!trim(current).empty()) parts.push_back(trim(current));
+    return parts;
+}
+
+double parseNumber(const std::string& token, const StageTable& table) {
+    auto define = table.defines.find(token);
+    if (define != table.defines.end()) return define->second;
+    char* end;
+    double value = std::strtod(token.c_str(), &end);
+    if (end == token.c_str() || (*end && std::string(end) != "f")) {
+        throw std::runtime_error("startStages: cannot read value '" + token + "'");
+    }
+    return value;
+}
+
+Range parseRange(const std::string& token, const StageTable& table) {
+    std::vector<std::string> ends;
+    if (token.size() >= 2 && token.front() == '{' && token.back() == '}') {
+        ends = splitTopLevel(token.substr(1, token.size() - 2));
+    }
+    if (ends.size() != 2) throw std::runtime_error("startStages: expected {start, end}, got '" + token + "'");
+    return {static_cast<int>(parseNumber(ends[0], table)), static_cast<int>(parseNumber(ends[1], table))};
+}
+
+bool parseBool(const std::string& token) {
+    if (token == "true") return true;
+    if (token == "false") return false;
+    throw std::runtime_error("startStages: expected true or false, got '" + token + "'");
+}
+
+// Reads the startStages table of a Stages.h, resolving the file's own #defines
+StageTable parseStartStages(const std::string& path) {
+    std::string text = stripComments(readFile(path));
+    StageTable table;
+
+    std::istringstream lines(text);
+    std::string line;
+    while (std::getline(lines, line)) {
+        std::istringstream words(line);
+        std::string directive, name, value;
+        if (!(words >> directive >> name >> value) || directive != "#define") continue;
+        char* end;
+        long number = std::strtol(value.c_str(), &end, 10);
+        if (*end == '\0') table.defines[name] = static_cast<int>(number);
+    }
+
+    size_t begin = text.find("const Stage startStages[]");
+    if (begin == std::string::npos) throw std::runtime_error(path + ": no startStages table");
+    begin = text.find('{', begin);
+    size_t end = text.find("\n};", begin);
+    if (begin == std::string::npos || end == std::string::npos) {
+        throw std::runtime_error(path + ": unterminated startStages table");
+    }
+
+    std::vector<std::map<std::string, std::string>> entries;
+    for (const std::string& entry : splitTopLevel(text.substr(begin + 1, end - begin - 1))) {
+        if (entry.size() < 2 || entry.front() != '{' || entry.back() != '}') {
+            throw std::runtime_error(path + ": expected a { ... } stage in startStages");
+        }
+        std::map<std::string, std::string> fields;
+        for (const std::string& item : splitTopLevel(entry.substr(1, entry.size() - 2))) {
+            size_t eq = item.find('=');
+            if (item.empty() || item[0] != '.' || eq == std::string::npos) {
+                throw std::runtime_error(path + ": expected designated initialisers in startStages");
+            }
+            fields[trim(item.substr(1, eq - 1))] = trim(item.substr(eq + 1));
+        }
+        entries.push_back(fields);
+    }
+    if (entries.empty()) throw std::runtime_error(path + ": startStages is empty");
+
+    for (const auto& fields : entries) {
+        auto field = [&](const char* name) {
+            auto it = fields.find(name);
+            if (it == fields.end()) throw std::runtime_error(path + ": a start stage has no ." + name);
+            return it->second;
+        };
+        std::string message = field("message");
+        if (message.size() < 2 || message.front() != '"' || message.back() != '"') {
+            throw std::runtime_error(path + ": .message must be a string literal");
+        }
+        table.messages.push_back(message.substr(1, message.size() - 2));
+
+        Stage s;
+        s.message = nullptr;
+        s.duration = static_cast<float>(parseNumber(field("duration"), table));
+        std::string condition = field("condition");
+        if (condition == "&largeCondition") s.condition = &largeCondition;
+        else if (condition == "&smallCondition") s.condition = &smallCondition;
+        else if (condition == "nullptr" || condition == "NULL") s.condition = nullptr;
+        else throw std::runtime_error(path + ": unknown condition " + condition);
+        s.waterPumpState = parseBool(field("waterPumpState"));
+        s.blowerState = parseBool(field("blowerState"));
+        s.glowState = parseBool(field("glowState"));
+        s.fanSpeed = parseRange(field("fanSpeed"), table);
+        s.fuelPump = parseRange(field("fuelPump"), table);
+        table.stages.push_back(s);
+    }
+    for (size_t i = 0; i < table.stages.size(); i++) table.stages[i].message = table.messages[i].c_str();
+    return table;
+}
+
+// Burner spread the table must cope with
+std::vector<BurnerParams> scenarios() {
+    BurnerParams nominal;
+
+    BurnerParams cold = nominal;
+    cold.ambientCelsius = -20;
+    cold.supplyVolts = 11.5;
+    cold.ignitionCelsius = 900;
+    cold.glowHeatCapacity = 1.9;
+
+    BurnerParams warm = nominal;
+    warm.ambientCelsius = 25;
+    warm.supplyVolts = 14;
+
+    BurnerParams weakFan = nominal;
+    weakFan.airMaxKgPerHour = 10;
+    weakFan.ignitionPoolMl = 0.08;
+
+    return {nominal, cold, warm, weakFan};
+}
+
+// Stage table decoded from a parameter vector; owns what Stage points into
+struct Candidate {
+    std::vector<Stage> stages;
+};
+
+const int PARAMS_PER_STAGE = 5;   // duration, fan start/end, fuel start/end
+
+std::vector<double> encode(const Stage* stages, int count) {
+    std::vector<double> x;
+    for (int i = 0; i < count; i++) {
+        x.push_back(stages[i].duration);
+        x.push_back(stages[i].fanSpeed.start);
+        x.push_back(stages[i].fanSpeed.end);
+        x.push_back(stages[i].fuelPump.start);
+        x.push_back(stages[i].fuelPump.end);
+    }
+    return x;
+}
+
+void bounds(int index, double& low, double& high) {
+    switch (index % PARAMS_PER_STAGE) {
+        case 0: low = MIN_DURATION; high = MAX_DURATION; break;
+        case 1: case 2: low = FAN_SPEED_OFF; high = FAN_SPEED_LARGE; break;
+        default: low = FUEL_PUMP_OFF; high = FUEL_PUMP_HIGH; break;
+    }
+}
+
+// Rounds to what the firmware can express; the last stage keeps its ramp so
+// the hand-over to LARGE stays continuous
+Candidate decode(const std::vector<double>& x, const Stage* base, int count) {
+    Candidate c;
+    c.stages.assign(base, base + count);
+    for (int i = 0; i < count; i++) {
+        const double* v = &x[i * PARAMS_PER_STAGE];
+        Stage& s = c.stages[i];
+        s.duration = std::round(std::min(std::max(v[0], MIN_DURATION), MAX_DURATION));
+        if (i == count - 1) continue;
+        auto clampRound = [](double value, double low, double high) {
+            return static_cast<int>(std::lround(std::min(std::max(value, low), high)));
+        };
+        s.fanSpeed = {clampRound(v[1], FAN_SPEED_OFF, FAN_SPEED_LARGE), clampRound(v[2], FAN_SPEED_OFF, FAN_SPEED_LARGE)};
+        s.fuelPump = {clampRound(v[3], FUEL_PUMP_OFF, FUEL_PUMP_HIGH), clampRound(v[4], FUEL_PUMP_OFF, FUEL_PUMP_HIGH)};
+    }
+    return c;
+}
+
+struct Outcome {
+    double violation = 0;             // 0 when every constraint holds
+    double timeToLarge = 0;
+    double timeToFlame = 0;
+    double startFuelMl = 0;
+    double cost = 0;
+};
+
+// Runs one scenario through the real state machine
+Outcome simulate(const Candidate& c, const BurnerParams& params, const Options& opt) {
+    BurnerModel burner(params);
+    SimulatedHardware hw(burner);
+    StateMachine<SimulatedHardware> sm(hw);
+    sm.setStartStages(c.stages.data(), static_cast<int>(c.stages.size()));
+    sm.init();
+    sm.setRunSignal(true);
+
+    Outcome out;
+    const unsigned long tickMs = 1000;    // loop() delay
+    double largeAt = -1;
+    bool glowWasOn = false;
+
+    for (double t = 0; t < START_LIMIT_SECONDS + TAIL_SECONDS; t += tickMs / 1000.0) {
+        sm.tick();
+
+        State state = sm.getCurrentState();
+        if (state == SHUTDOWN || state == IDLE) {
+            out.violation += 100;         // Aborted start
+            break;
+        }
+        if (largeAt < 0 && state != START) {
+            largeAt = t;
+            out.startFuelMl = burner.fuelDeliveredMl();
+            if (!burner.lit()) out.violation += 50;
+        }
+
+        // Fuel needs an ignition source, a flame needs cooling air
+        bool glowOn = burner.glowVolts() > 1;
+        if (burner.fuelRate() > 0 && !burner.lit() && !glowOn) out.violation += 1;
+        if (burner.lit() && burner.fan() < MIN_FAN_WHILE_LIT) out.violation += 1;
+        if (glowWasOn && !glowOn) {
+            double litFor = burner.lit() ? t - burner.ignitionSeconds() : 0;
+            if (litFor < MIN_LIT_BEFORE_GLOW_OFF) out.violation += MIN_LIT_BEFORE_GLOW_OFF - litFor;
+        }
+        glowWasOn = glowOn;
+
+        hw.run(tickMs);
+
+        if (burner.poolMl() > MAX_POOL_ML) out.violation += burner.poolMl() - MAX_POOL_ML;
+        if (burner.glowCelsius() > params.glowLimitCelsius) {
+            out.violation += (burner.glowCelsius() - params.glowLimitCelsius) / 100;
+        }
+
+        if (largeAt >= 0 && t >= largeAt + TAIL_SECONDS) break;
+    }
+
+    if (largeAt < 0) {
+        out.violation += 100;
+        largeAt = START_LIMIT_SECONDS;
+    }
+    out.violation += 20 * burner.flameouts();
+    out.violation += std::max(burner.fuelVentedMl() - MAX_VENTED_ML, 0.0);
+
+    out.timeToLarge = largeAt;
+    out.timeToFlame = burner.ignitionSeconds() >= 0 ? burner.ignitionSeconds() : START_LIMIT_SECONDS;
+    out.cost = out.timeToLarge + opt.flameWeight * out.timeToFlame + opt.fuelWeight * out.startFuelMl;
+    return out;
+}
+
+// Worst scenario decides; infeasible candidates rank below all feasible ones
+struct Score {
+    double fitness;
+    Outcome worst;
+};
+
+Score evaluate(const Candidate& c, const std::vector<BurnerParams>& cases, const Options& opt) {
+    Score score;
+    score.worst.cost = -1;
+    double violation = 0;
+    for (const BurnerParams& params : cases) {
+        Outcome o = simulate(c, params, opt);
+        violation += o.violation;
+        if (o.cost > score.worst.cost) score.worst = o;
+    }
+    score.worst.violation = violation;
+    score.fitness = violation > 0 ? 1e4 + 100 * violation : score.worst.cost;
+    return score;
+}
+
+// Evaluates a batch of vectors across worker threads
+std::vector<Score> evaluateAll(const std::vector<std::vector<double>>& xs, const Stage* base, int count,
+                               const std::vector<BurnerParams>& cases, const Options& opt) {
+    std::vector<Score> scores(xs.size());
+    std::atomic<size_t> next(0);
+    unsigned threads = opt.threads ? opt.threads : std::max(1u, std::thread::hardware_concurrency());
+
+    std::vector<std::thread> workers;
+    for (unsigned w = 0; w < threads; w++) {
+        workers.emplace_back([&]() {
+            for (size_t i = next++; i < xs.size(); i = next++) {
+                scores[i] = evaluate(decode(xs[i], base, count), cases, opt);
+            }
+        });
+    }
+    for (std::thread& worker : workers) worker.join();
+    return scores;
+}
+
+// Named level from the stages file when one matches, else the number
+std::string macroFor(int value, const std::string& prefix, const std::map<std::string, int>& defines) {
+    for (const auto& define : defines) {
+        if (define.first.compare(0, prefix.size(), prefix) == 0 && define.second == value) return define.first;
+    }
+    return std::to_string(value);
+}
+
+// Stage table in the layout of Stages.h
+std::string formatStartStages(const Candidate& c, const Score& score, const std::map<std::string, int>& defines) {
+    std::ostringstream s;
+    char line[160];
+    std::snprintf(line, sizeof(line),
+                  "// Define start stages (tuned by tools/optimizeStart: worst case %.0f s to LARGE, "
+                  "flame at %.0f s, %.1f ml)\n", score.worst.timeToLarge, score.worst.timeToFlame,
+                  score.worst.startFuelMl);
+    s << line << "const Stage startStages[] = {\n";
+
+    double startTime = 0;
+    for (size_t i = 0; i < c.stages.size(); i++) {
+        const Stage& st = c.stages[i];
+        const char* condition = st.condition == &largeCondition ? "&largeCondition"
+                              : st.condition == &smallCondition ? "&smallCondition" : "nullptr";
+        s << "    {\n"
+          << "        .message = \"START: Stage " << i + 1 << " (" << startTime << ")\",\n"
+          << "        .duration = " << st.duration << ".0,\n"
+          << "        .condition = " << condition << ",\n"
+          << "        .waterPumpState = " << (st.waterPumpState ? "true" : "false") << ",\n"
+          << "        .blowerState = " << (st.blowerState ? "true" : "false") << ",\n"
+          << "        .glowState = " << (st.glowState ? "true" : "false") << ",\n"
+          << "        .fanSpeed = {" << macroFor(st.fanSpeed.start, "FAN_SPEED_", defines) << ", "
+          << macroFor(st.fanSpeed.end, "FAN_SPEED_", defines) << "},\n"
+          << "        .fuelPump = {" << macroFor(st.fuelPump.start, "FUEL_PUMP_", defines) << ", "
+          << macroFor(st.fuelPump.end, "FUEL_PUMP_", defines) << "}\n"
+          << "    }" << (i + 1 < c.stages.size() ? "," : "") << "\n";
+        startTime += st.duration;
+    }
+    s << "};\n";
+    return s.str();
+}
+
+// Replaces the startStages block of the existing Stages.h
+std::string spliceStages(const std::string& path, const std::string& table) {
+    std::string text = readFile(path);
+
+    size_t begin = text.find("const Stage startStages[]");
+    if (begin == std::string::npos) throw std::runtime_error(path + ": no startStages table");
+    size_t comment = text.rfind("// Define start stages", begin);
+    if (comment != std::string::npos && text.find('\n', comment) + 1 == begin) begin = comment;
+    size_t end = text.find("\n};", begin);
+    if (end == std::string::npos) throw std::runtime_error(path + ": unterminated startStages table");
+    end += 4;
+
+    return text.substr(0, begin) + table + text.substr(end);
+}
+
+void printOutcome(const char* label, const Score& score) {
+    std::fprintf(stderr, "%-9s %s: %.0f s to LARGE, flame at %.0f s, %.2f ml before LARGE (cost %.1f)\n", label,
+                 score.worst.violation > 0 ? "UNSAFE" : "safe", score.worst.timeToLarge, score.worst.timeToFlame,
+                 score.worst.startFuelMl, score.worst.cost);
+}
+
+void usage() {
+    std::fprintf(stderr,
+                 "usage: optimizeStart [options]\n"
+                 "  --stages <file>      Stages.h whose startStages to tune (default ../src/Stages.h)\n"
+                 "  --out <file>         write the tuned Stages.h here (default stdout)\n"
+                 "  --report <file>      per-generation convergence CSV\n"
+                 "  --generations <n>    default 150\n"
+                 "  --population <n>     default 60\n"
+                 "  --flame-weight <w>   cost per second to first flame (default 0.5)\n"
+                 "  --fuel-weight <w>    cost per ml before LARGE (default 20)\n"
+                 "  --threads <n>        worker threads (default: all cores)\n"
+                 "  --seed <n>           random seed (default 1)\n");
+}
+
+Options parseArgs(int argc, char** argv) {
+    Options opt;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) throw std::runtime_error("missing value for " + arg);
+        const char* value = argv[++i];
+
+        if (arg == "--stages") opt.stagesPath = value;
+        else if (arg == "--out") opt.out = value;
+        else if (arg == "--report") opt.report = value;
+        else if (arg == "--generations") opt.generations = std::atoi(value);
+        else if (arg == "--population") opt.population = std::atoi(value);
+        else if (arg == "--flame-weight") opt.flameWeight = std::atof(value);
+        else if (arg == "--fuel-weight") opt.fuelWeight = std::atof(value);
+        else if (arg == "--threads") opt.threads = static_cast<unsigned>(std::atoi(value));
+        else if (arg == "--seed") opt.seed = std::strtoul(value, nullptr, 10);
+        else throw std::runtime_error("unknown option " + arg);
+    }
+    if (opt.population < 4) throw std::runtime_error("--population must be at least 4");
+    if (opt.generations < 1) throw std::runtime_error("--generations must be positive");
+    return opt;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    try {
+        Options opt = parseArgs(argc, argv);
+        std::vector<BurnerParams> cases = scenarios();
+        StageTable hand = parseStartStages(opt.stagesPath);
+        const Stage* base = hand.stages.data();
+        const int count = static_cast<int>(hand.stages.size());
+
+        std::vector<double> seedVector = encode(base, count);
+        Score baseline = evaluate(decode(seedVector, base, count), cases, opt);
+        printOutcome("hand", baseline);
+
+        // Population: the hand table, variants of it, and uniform samples
+        std::mt19937_64 rng(opt.seed);
+        std::uniform_real_distribution<double> unit(0.0, 1.0);
+        std::normal_distribution<double> jitter(0.0, 0.1);
+        size_t dims = seedVector.size();
+        std::vector<std::vector<double>> population = {seedVector};
+        while (static_cast<int>(population.size()) < opt.population) {
+            bool nearHand = population.size() % 2 == 1;
+            std::vector<double> x(dims);
+            for (size_t d = 0; d < dims; d++) {
+                double low, high;
+                bounds(static_cast<int>(d), low, high);
+                double v = nearHand ? seedVector[d] + jitter(rng) * (high - low) : low + unit(rng) * (high - low);
+                x[d] = std::min(std::max(v, low), high);
+            }
+            population.push_back(x);
+        }
+        std::vector<Score> scores = evaluateAll(population, base, count, cases, opt);
+
+        FILE* report = opt.report.empty() ? nullptr : std::fopen(opt.report.c_str(), "w");
+        if (!opt.report.empty() && !report) throw std::runtime_error("cannot write " + opt.report);
+        if (report) std::fprintf(report, "generation,best_cost,mean_feasible_cost,feasible,best_time_to_large,best_time_to_flame,best_fuel_ml\n");
+
+        // DE/rand/1/bin
+        const double F = 0.6, CR = 0.9;
+        std::uniform_int_distribution<size_t> pick(0, population.size() - 1);
+        std::uniform_int_distribution<size_t> pickDim(0, dims - 1);
+        for (int g = 0; g < opt.generations; g++) {
+            std::vector<std::vector<double>> trials(population.size());
+            for (size_t i = 0; i < population.size(); i++) {
+                size_t a, b, c;
+                do { a = pick(rng); } while (a == i);
+                do { b = pick(rng); } while (b == i || b == a);
+                do { c = pick(rng); } while (c == i || c == a || c == b);
+                size_t forced = pickDim(rng);
+
+                trials[i] = population[i];
+                for (size_t d = 0; d < dims; d++) {
+                    if (d != forced && unit(rng) >= CR) continue;
+                    double low, high;
+                    bounds(static_cast<int>(d), low, high);
+                    double v = population[a][d] + F * (population[b][d] - population[c][d]);
+                    trials[i][d] = std::min(std::max(v, low), high);
+                }
+            }
+
+            std::vector<Score> trialScores = evaluateAll(trials, base, count, cases, opt);
+            for (size_t i = 0; i < population.size(); i++) {
+                if (trialScores[i].fitness <= scores[i].fitness) {
+                    population[i] = trials[i];
+                    scores[i] = trialScores[i];
+                }
+            }
+
+            size_t best = 0;
+            int feasible = 0;
+            double feasibleSum = 0;
+            for (size_t i = 0; i < scores.size(); i++) {
+                if (scores[i].fitness < scores[best].fitness) best = i;
+                if (scores[i].worst.violation == 0) {
+                    feasible++;
+                    feasibleSum += scores[i].fitness;
+                }
+            }
+            const Outcome& top = scores[best].worst;
+            if (report) {
+                std::fprintf(report, "%d,%.2f,%.2f,%d,%.0f,%.0f,%.3f\n", g + 1, scores[best].fitness,
+                             feasible ? feasibleSum / feasible : NAN, feasible, top.timeToLarge, top.timeToFlame,
+                             top.startFuelMl);
+            }
+            if ((g + 1) % 10 == 0 || g + 1 == opt.generations) {
+                std::fprintf(stderr, "generation %4d: best %.1f, %d/%zu feasible\n", g + 1, scores[best].fitness,
+                             feasible, scores.size());
+            }
+        }
+        if (report) std::fclose(report);
+
+        size_t best = std::min_element(scores.begin(), scores.end(), [](const Score& a, const Score& b) {
+            return a.fitness < b.fitness;
+        }) - scores.begin();
+        Candidate tuned = decode(population[best], base, count);
+        printOutcome("tuned", scores[best]);
+        if (scores[best].worst.violation > 0) throw std::runtime_error("no safe table found; not writing one");
+
+        std::string text = spliceStages(opt.stagesPath, formatStartStages(tuned, scores[best], hand.defines));
+        if (opt.out.empty()) {
+            std::fputs(text.c_str(), stdout);
+        } else {
+            std::ofstream out(opt.out);
+            if (!(out << text)) throw std::runtime_error("cannot write " + opt.out);
+        }
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "optimizeStart: %s\n", e.what());
+        usage();
+        return 1;
+    }
+    return 0;
+}